@@ -0,0 +1,109 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/detector_passes.hpp"
+
+// OpenCV
+#include <opencv2/imgproc.hpp>
+
+// STD
+#include <algorithm>
+#include <random>
+
+namespace rm_vision_bringup
+{
+cv::Mat makeSyntheticFrame(int light_pairs, int enemy_color, uint32_t seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> x(100.f, kFrameWidth - 100.f);
+  std::uniform_real_distribution<float> y(100.f, kFrameHeight - 100.f);
+  std::uniform_real_distribution<float> length(20.f, 80.f);
+  std::uniform_real_distribution<float> tilt(-20.f, 20.f);
+
+  // Dark, slightly noisy background as seen with a short exposure
+  cv::Mat frame(kFrameHeight, kFrameWidth, CV_8UC3);
+  cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(40));
+
+  const cv::Scalar glow = enemy_color == 0 ? cv::Scalar(255, 80, 80) : cv::Scalar(80, 80, 255);
+  const cv::Scalar core(255, 255, 255);
+  for (int i = 0; i < light_pairs; i++) {
+    cv::Point2f center(x(rng), y(rng));
+    float bar_length = length(rng);
+    float angle = tilt(rng);
+    // Two light bars of an armor, about two bar lengths apart
+    for (float side : {-1.f, 1.f}) {
+      cv::Point2f bar_center = center + cv::Point2f(side * bar_length, 0.f);
+      cv::RotatedRect bar(bar_center, cv::Size2f(bar_length / 5.f, bar_length), angle);
+      cv::ellipse(frame, bar, glow, cv::FILLED, cv::LINE_AA);
+      cv::RotatedRect bar_core(bar_center, cv::Size2f(bar_length / 10.f, bar_length * 0.9f), angle);
+      cv::ellipse(frame, bar_core, core, cv::FILLED, cv::LINE_AA);
+    }
+  }
+  return frame;
+}
+
+cv::Mat makeStressFrame(const StressFrameParams & params, int enemy_color, uint32_t seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::uniform_real_distribution<float> jitter(-1.f, 1.f);
+
+  cv::Mat frame(kFrameHeight, kFrameWidth, CV_8UC3);
+  cv::randu(
+    frame, cv::Scalar::all(std::max(0.f, params.noise_mean - params.noise_amplitude)),
+    cv::Scalar::all(std::min(255.f, params.noise_mean + params.noise_amplitude)));
+  if (params.noise_blur > 1) {
+    int kernel = params.noise_blur | 1;
+    cv::GaussianBlur(frame, frame, cv::Size(kernel, kernel), 0);
+  }
+
+  const cv::Scalar enemy_glow =
+    enemy_color == 0 ? cv::Scalar(255, 80, 80) : cv::Scalar(80, 80, 255);
+  const cv::Scalar other_glow =
+    enemy_color == 0 ? cv::Scalar(80, 80, 255) : cv::Scalar(255, 80, 80);
+  const cv::Scalar core(255, 255, 255);
+
+  // Rows of bars, neighbours pair_spacing bar lengths apart
+  float length = std::max(6.f, params.light_length);
+  float step_x = std::max(length / 4.f, params.pair_spacing * length);
+  float step_y = length * 1.5f;
+  int per_row = std::max(1, static_cast<int>((kFrameWidth - 2 * length) / step_x));
+  for (int i = 0; i < params.lights; i++) {
+    int row = i / per_row;
+    cv::Point2f center(
+      length + (i % per_row) * step_x + jitter(rng) * length * 0.1f,
+      length + row * step_y + jitter(rng) * length * 0.1f);
+    if (center.y > kFrameHeight - length) {
+      break;
+    }
+    // Lengths and tilts near the limits of the light and armor filters
+    float bar_length = length * (1.f + 0.2f * jitter(rng));
+    float angle = 15.f * jitter(rng);
+    const cv::Scalar & glow = unit(rng) < params.enemy_fraction ? enemy_glow : other_glow;
+    cv::ellipse(
+      frame, cv::RotatedRect(center, cv::Size2f(bar_length / 4.f, bar_length), angle), glow,
+      cv::FILLED, cv::LINE_AA);
+    cv::ellipse(
+      frame, cv::RotatedRect(center, cv::Size2f(bar_length / 8.f, bar_length * 0.9f), angle),
+      core, cv::FILLED, cv::LINE_AA);
+  }
+  return frame;
+}
+
+rm_auto_aim::Detector makeDetector(int binary_thres, int enemy_color)
+{
+  // Declared defaults of ArmorDetectorNode with the overrides of /armor_detector in
+  // config/node_params.yaml (light.min_ratio, armor.min_light_ratio), keep them in sync
+  rm_auto_aim::Detector::LightParams light_params = {0.1, 0.4, 40.0};
+  rm_auto_aim::Detector::ArmorParams armor_params = {0.8, 0.8, 3.2, 3.2, 5.5, 35.0};
+  return rm_auto_aim::Detector(binary_thres, enemy_color, light_params, armor_params);
+}
+
+Detection detectFrame(rm_auto_aim::Detector & detector, const cv::Mat & rgb)
+{
+  cv::Mat binary = detector.preprocessImage(rgb);
+  auto lights = detector.findLights(rgb, binary);
+  auto armors = detector.matchLights(lights);
+  return {lights.size(), armors.size()};
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,232 @@
+// Copyright 2023 Chen Jun
+
+// Measures achieved bandwidth and operation rate of the detector's full-frame passes on
+// 1440x1080 synthetic frames and places them on a roofline built from the measured memory
+// bandwidth and 8-bit SIMD throughput of this machine.
+// Usage: detector_roofline [threads] [iterations]
+
+// OpenCV
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/detector_passes.hpp"
+#include "rm_vision_bringup/proc_stat.hpp"
+
+namespace
+{
+struct Pass
+{
+  std::string name;
+  // Compulsory memory traffic and arithmetic per pixel, the model behind the roofline
+  double bytes_per_pixel;
+  double ops_per_pixel;
+  std::function<void()> run;
+};
+
+double medianSeconds(const std::function<void()> & run, int iterations)
+{
+  for (int i = 0; i < 5; i++) {
+    run();
+  }
+  std::vector<double> times(iterations);
+  for (auto & t : times) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+  return times[iterations / 2];
+}
+
+// Runs fn(thread_index) on `threads` threads at once, returns the wall time
+double parallelSeconds(int threads, const std::function<void(int)> & fn)
+{
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back(fn, i);
+  }
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// STREAM-like copy of buffers much larger than the last level cache, bytes/s
+double measureBandwidth(int threads)
+{
+  const size_t bytes_per_thread = size_t{64} << 20;
+  std::vector<std::vector<char>> src(threads, std::vector<char>(bytes_per_thread, 1));
+  std::vector<std::vector<char>> dst(threads, std::vector<char>(bytes_per_thread, 0));
+
+  const int repeats = 5;
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    double seconds = parallelSeconds(threads, [&](int i) {
+      std::memcpy(dst[i].data(), src[i].data(), bytes_per_thread);
+    });
+    // memcpy reads and writes every byte
+    best = std::max(best, 2.0 * bytes_per_thread * threads / seconds);
+  }
+  return best;
+}
+
+typedef uint8_t Bytes32 __attribute__((vector_size(32)));
+
+// OpenCV dispatches its kernels to the best instruction set at runtime, so must the baseline
+#if defined(__x86_64__)
+#define RM_SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define RM_SIMD_CLONES
+#endif
+
+// Wrapping 8-bit adds of an L1-resident buffer into eight independent accumulators, one load
+// and one vector add per 32 bytes with no call or size checks in between. Returns the adds done.
+RM_SIMD_CLONES
+uint64_t addLoop(const Bytes32 * data, size_t vectors, int repeats, Bytes32 * result)
+{
+  Bytes32 a0 = {}, a1 = {}, a2 = {}, a3 = {}, a4 = {}, a5 = {}, a6 = {}, a7 = {};
+  for (int r = 0; r < repeats; r++) {
+    // The data may have changed, so the sums cannot be hoisted out of the loop
+    asm volatile("" : : "r"(data) : "memory");
+    for (size_t i = 0; i + 8 <= vectors; i += 8) {
+      a0 += data[i];
+      a1 += data[i + 1];
+      a2 += data[i + 2];
+      a3 += data[i + 3];
+      a4 += data[i + 4];
+      a5 += data[i + 5];
+      a6 += data[i + 6];
+      a7 += data[i + 7];
+    }
+  }
+  *result = a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7;
+  return static_cast<uint64_t>(repeats) * (vectors / 8 * 8) * sizeof(Bytes32);
+}
+
+// Peak 8-bit SIMD adds, ops/s
+double measureCompute(int threads)
+{
+  // 16 KiB per thread stays in L1
+  const size_t vectors = 512;
+  const int repeats = 100000;
+  std::vector<Bytes32 *> buffers(threads);
+  std::vector<uint8_t> sinks(threads);
+  for (auto & buffer : buffers) {
+    buffer = static_cast<Bytes32 *>(std::aligned_alloc(64, vectors * sizeof(Bytes32)));
+    std::memset(buffer, 1, vectors * sizeof(Bytes32));
+  }
+
+  double best = 0.0;
+  for (int r = 0; r < 3; r++) {
+    std::vector<uint64_t> ops(threads);
+    double seconds = parallelSeconds(threads, [&](int i) {
+      Bytes32 result;
+      ops[i] = addLoop(buffers[i], vectors, repeats, &result);
+      sinks[i] = result[0];
+    });
+    best = std::max(best, ops[0] * static_cast<double>(threads) / seconds);
+  }
+  for (auto & buffer : buffers) {
+    std::free(buffer);
+  }
+  return best;
+}
+
+// Vector bytes times the two loads per cycle the loop above is limited by
+double nominalCompute(int threads)
+{
+#if defined(__x86_64__)
+  int vector_bytes = __builtin_cpu_supports("avx2") ? 32 : 16;
+#else
+  int vector_bytes = 16;
+#endif
+  return vector_bytes * 2.0 * rm_vision_bringup::meanCpuFrequencyMhz() * 1e6 * threads;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  int threads = argc > 1 ? std::atoi(argv[1]) : cv::getNumberOfCPUs();
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+  std::printf("Measuring machine baseline with %d threads...\n", threads);
+  const double peak_bandwidth = measureBandwidth(threads);
+  const double peak_ops = measureCompute(threads);
+  const double nominal_ops = nominalCompute(threads);
+  if (!std::isnan(nominal_ops)) {
+    std::printf(
+      "Peak 8-bit ops %.1f Gops/s, nominal %.1f Gops/s at the current clock\n", peak_ops / 1e9,
+      nominal_ops / 1e9);
+    // Turbo and frequency changes during the run allow some deviation, not a factor of two
+    if (peak_ops < 0.5 * nominal_ops || peak_ops > 2.0 * nominal_ops) {
+      std::printf("Warning: measured peak is far from nominal, the ridge point is unreliable\n");
+    }
+  } else {
+    std::printf("CPU frequency unknown, peak 8-bit ops not checked against nominal\n");
+  }
+  cv::setNumThreads(threads);
+
+  const cv::Mat rgb = rm_vision_bringup::makeSyntheticFrame(8, 0, 0);
+  const double pixels = static_cast<double>(rgb.total());
+  auto detector = rm_vision_bringup::makeDetector(80, 0);
+  cv::Mat binary = detector.preprocessImage(rgb);
+
+  std::vector<cv::Mat> channels;
+  cv::Mat diff, dilated;
+  const cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+
+  std::vector<Pass> passes = {
+    // RGB to gray (3 bytes in, 1 out, 5 ops) and threshold (1 in, 1 out, 1 op)
+    {"preprocessImage", 6.0, 6.0, [&]() { binary = detector.preprocessImage(rgb); }},
+    // Modelled by its contour scan of the binary image, the few light candidates add little
+    {"findLights", 1.0, 2.0, [&]() { detector.findLights(rgb, binary); }},
+    // Alternatives used by other detectors, measured for comparison
+    {"split+subtract", 9.0, 1.0,
+     [&]() {
+       cv::split(rgb, channels);
+       cv::subtract(channels[0], channels[2], diff);
+     }},
+    {"dilate3x3", 2.0, 4.0, [&]() { cv::dilate(binary, dilated, kernel); }},
+  };
+
+  std::printf(
+    "\nFrame %dx%d, %d threads, median of %d runs\n", rgb.cols, rgb.rows, threads, iterations);
+  std::printf(
+    "Peak bandwidth %.1f GB/s, peak 8-bit ops %.1f Gops/s, ridge point %.2f ops/byte\n\n",
+    peak_bandwidth / 1e9, peak_ops / 1e9, peak_ops / peak_bandwidth);
+  std::printf(
+    "%-16s %8s %8s %9s %9s %9s %10s %9s\n", "pass", "ms", "GB/s", "Gops/s", "ops/byte",
+    "%peakBW", "bound", "%roof");
+
+  for (const auto & pass : passes) {
+    double seconds = medianSeconds(pass.run, iterations);
+    double bytes_per_sec = pass.bytes_per_pixel * pixels / seconds;
+    double ops_per_sec = pass.ops_per_pixel * pixels / seconds;
+    double intensity = pass.ops_per_pixel / pass.bytes_per_pixel;
+    // Attainable rate at this arithmetic intensity
+    double roof = std::min(peak_ops, intensity * peak_bandwidth);
+    bool memory_bound = intensity * peak_bandwidth < peak_ops;
+    std::printf(
+      "%-16s %8.3f %8.2f %9.2f %9.2f %9.1f %10s %9.1f\n", pass.name.c_str(), seconds * 1e3,
+      bytes_per_sec / 1e9, ops_per_sec / 1e9, intensity, bytes_per_sec / peak_bandwidth * 100.0,
+      memory_bound ? "memory" : "compute", ops_per_sec / roof * 100.0);
+  }
+
+  std::printf(
+    "\nBytes and ops are the compulsory per-pixel model of each pass, not counted events.\n");
+  return 0;
+}
@@ -0,0 +1,321 @@
+// Copyright 2023 Chen Jun
+
+// Builds and runs a worst-case frame set for the detector's timing.
+//
+// search: synthesizes 1440x1080 frames with many light-like bars, dense pairs and background
+//         noise around the binary threshold, random-searches their parameters for the slowest
+//         detector passes and adds the slowest frames to the set as stress_<seed>.png.
+// bench:  runs the detector passes over every PNG in the set and reports the mean, p99 and
+//         p99.9 time next to ordinary synthetic frames, failing if p99.9 exceeds --budget-ms.
+//         Recorded frames that were slow on the robot (reflections, LED screens) can be added to
+//         the set as PNGs in the camera's rgb8 channel order.
+//
+// Usage: detector_worst_case search [--dir D] [--candidates N] [--keep N] [--seed N]
+//        detector_worst_case bench [--dir D] [--samples N] [--budget-ms ms]
+//   common options: [--binary-thres 80] [--enemy-color 0]
+//   default dir: $ROS_HOME/detector_worst_case (~/.ros)
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+// OpenCV
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/detector_passes.hpp"
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace
+{
+struct Options
+{
+  std::string command;
+  std::string dir;
+  int candidates = 300;
+  int keep = 8;
+  uint32_t seed = 1;
+  int samples = 5000;
+  double budget_ms = 0.0;
+  int binary_thres = 80;
+  int enemy_color = 0;
+};
+
+struct Candidate
+{
+  rm_vision_bringup::StressFrameParams params;
+  uint32_t seed;
+  double ms;
+  size_t lights;
+  size_t armors;
+};
+
+double detectMs(
+  const cv::Mat & frame, rm_auto_aim::Detector & detector,
+  rm_vision_bringup::Detection * detection = nullptr)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto result = rm_vision_bringup::detectFrame(detector, frame);
+  double ms =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (detection != nullptr) {
+    *detection = result;
+  }
+  return ms;
+}
+
+// Fastest of a few runs, so the ranking follows the frame content rather than scheduling noise
+double frameCostMs(
+  const cv::Mat & frame, rm_auto_aim::Detector & detector,
+  rm_vision_bringup::Detection & detection)
+{
+  double best = detectMs(frame, detector, &detection);
+  for (int i = 0; i < 2; i++) {
+    best = std::min(best, detectMs(frame, detector));
+  }
+  return best;
+}
+
+rm_vision_bringup::StressFrameParams randomParams(std::mt19937 & rng, int binary_thres)
+{
+  auto uniform = [&rng](float low, float high) {
+    return std::uniform_real_distribution<float>(low, high)(rng);
+  };
+  rm_vision_bringup::StressFrameParams params;
+  params.lights = static_cast<int>(uniform(8.f, 400.f));
+  params.light_length = uniform(8.f, 120.f);
+  params.pair_spacing = uniform(0.5f, 5.5f);
+  params.enemy_fraction = uniform(0.3f, 1.f);
+  params.noise_mean = uniform(0.f, binary_thres * 1.2f);
+  params.noise_amplitude = uniform(0.f, 60.f);
+  params.noise_blur = static_cast<int>(uniform(1.f, 15.f));
+  return params;
+}
+
+// Small step around a slow candidate
+rm_vision_bringup::StressFrameParams mutate(
+  const rm_vision_bringup::StressFrameParams & base, std::mt19937 & rng)
+{
+  auto scale = [&rng]() { return std::uniform_real_distribution<float>(0.8f, 1.25f)(rng); };
+  rm_vision_bringup::StressFrameParams params = base;
+  params.lights = std::max(1, static_cast<int>(base.lights * scale()));
+  params.light_length = std::clamp(base.light_length * scale(), 6.f, 200.f);
+  params.pair_spacing = std::clamp(base.pair_spacing * scale(), 0.3f, 6.f);
+  params.enemy_fraction = std::clamp(base.enemy_fraction * scale(), 0.f, 1.f);
+  params.noise_mean = std::clamp(base.noise_mean * scale(), 0.f, 255.f);
+  params.noise_amplitude = std::clamp(base.noise_amplitude * scale(), 0.f, 128.f);
+  params.noise_blur = std::clamp(static_cast<int>(base.noise_blur * scale()), 1, 31);
+  return params;
+}
+
+int search(const Options & options)
+{
+  std::mt19937 rng(options.seed);
+  auto detector = rm_vision_bringup::makeDetector(options.binary_thres, options.enemy_color);
+  std::vector<Candidate> best;
+
+  auto evaluate = [&](const rm_vision_bringup::StressFrameParams & params) {
+    Candidate candidate{params, static_cast<uint32_t>(rng()), 0.0, 0, 0};
+    cv::Mat frame =
+      rm_vision_bringup::makeStressFrame(params, options.enemy_color, candidate.seed);
+    rm_vision_bringup::Detection detection;
+    candidate.ms = frameCostMs(frame, detector, detection);
+    candidate.lights = detection.lights;
+    candidate.armors = detection.armors;
+    best.push_back(candidate);
+    std::sort(best.begin(), best.end(), [](const Candidate & a, const Candidate & b) {
+      return a.ms > b.ms;
+    });
+    if (best.size() > static_cast<size_t>(options.keep)) {
+      best.pop_back();
+    }
+  };
+
+  // Half the budget explores, the other half refines around the slowest frames so far
+  int explore = options.candidates / 2;
+  for (int i = 0; i < explore; i++) {
+    evaluate(randomParams(rng, options.binary_thres));
+  }
+  for (int i = explore; i < options.candidates; i++) {
+    const Candidate & parent = best[rng() % best.size()];
+    evaluate(mutate(parent.params, rng));
+  }
+
+  mkdir(options.dir.c_str(), 0755);
+  std::printf(
+    "%-24s %9s %7s %7s %7s %7s %8s %7s %7s %5s\n", "frame", "ms", "lights", "armors",
+    "bars", "length", "spacing", "enemy", "noise", "blur");
+  for (const auto & candidate : best) {
+    cv::Mat frame =
+      rm_vision_bringup::makeStressFrame(candidate.params, options.enemy_color, candidate.seed);
+    std::string name = "stress_" + std::to_string(candidate.seed) + ".png";
+    if (!cv::imwrite(options.dir + "/" + name, frame)) {
+      std::fprintf(stderr, "Failed to write %s/%s\n", options.dir.c_str(), name.c_str());
+      return 1;
+    }
+    const auto & p = candidate.params;
+    std::printf(
+      "%-24s %9.3f %7zu %7zu %7d %7.1f %8.2f %7.2f %3.0f+-%-3.0f %5d\n", name.c_str(),
+      candidate.ms, candidate.lights, candidate.armors, p.lights, p.light_length,
+      p.pair_spacing, p.enemy_fraction, p.noise_mean, p.noise_amplitude, p.noise_blur);
+  }
+  std::printf("\nAdded %zu frames to %s\n", best.size(), options.dir.c_str());
+  return 0;
+}
+
+struct Timing
+{
+  double mean;
+  double p99;
+  double p999;
+  double max;
+};
+
+Timing summarize(std::vector<double> times)
+{
+  std::sort(times.begin(), times.end());
+  double sum = 0.0;
+  for (double t : times) {
+    sum += t;
+  }
+  auto percentile = [&times](double p) {
+    return times[static_cast<size_t>(p * (times.size() - 1))];
+  };
+  return {sum / times.size(), percentile(0.99), percentile(0.999), times.back()};
+}
+
+int bench(const Options & options)
+{
+  std::vector<std::string> names;
+  if (DIR * dir = opendir(options.dir.c_str())) {
+    while (dirent * entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0) {
+        names.push_back(name);
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(names.begin(), names.end());
+
+  std::vector<cv::Mat> frames;
+  for (auto it = names.begin(); it != names.end(); ) {
+    cv::Mat frame = cv::imread(options.dir + "/" + *it, cv::IMREAD_COLOR);
+    if (frame.empty()) {
+      std::fprintf(stderr, "Failed to read %s, skipped\n", it->c_str());
+      it = names.erase(it);
+      continue;
+    }
+    frames.push_back(frame);
+    it++;
+  }
+  if (frames.empty()) {
+    std::fprintf(stderr, "No frames in %s, run search first\n", options.dir.c_str());
+    return 1;
+  }
+
+  std::vector<cv::Mat> ordinary;
+  for (uint32_t seed = 0; seed < 4; seed++) {
+    ordinary.push_back(rm_vision_bringup::makeSyntheticFrame(8, options.enemy_color, seed));
+  }
+
+  // Frames interleaved the way they arrive, after a warm-up of the OpenCV worker pool
+  auto detector = rm_vision_bringup::makeDetector(options.binary_thres, options.enemy_color);
+  auto run = [&](const std::vector<cv::Mat> & set, std::vector<double> * per_frame) {
+    for (int i = 0; i < 20; i++) {
+      detectMs(set[i % set.size()], detector);
+    }
+    std::vector<double> times;
+    for (int i = 0; i < options.samples; i++) {
+      double ms = detectMs(set[i % set.size()], detector);
+      times.push_back(ms);
+      if (per_frame != nullptr) {
+        per_frame[i % set.size()].push_back(ms);
+      }
+    }
+    return summarize(times);
+  };
+
+  std::vector<std::vector<double>> per_frame(frames.size());
+  Timing ordinary_timing = run(ordinary, nullptr);
+  Timing worst_timing = run(frames, per_frame.data());
+
+  std::printf("%-24s %9s %9s %9s %9s\n", "frame", "mean ms", "p99 ms", "p99.9 ms", "max ms");
+  for (size_t i = 0; i < frames.size(); i++) {
+    Timing timing = summarize(per_frame[i]);
+    std::printf(
+      "%-24s %9.3f %9.3f %9.3f %9.3f\n", names[i].c_str(), timing.mean, timing.p99,
+      timing.p999, timing.max);
+  }
+  std::printf(
+    "\n%-24s %9.3f %9.3f %9.3f %9.3f\n", "ordinary frames", ordinary_timing.mean,
+    ordinary_timing.p99, ordinary_timing.p999, ordinary_timing.max);
+  std::printf(
+    "%-24s %9.3f %9.3f %9.3f %9.3f\n", "worst-case set", worst_timing.mean, worst_timing.p99,
+    worst_timing.p999, worst_timing.max);
+
+  if (options.budget_ms > 0.0 && worst_timing.p999 > options.budget_ms) {
+    std::printf(
+      "\np99.9 of the worst-case set %.3f ms exceeds the budget of %.3f ms\n", worst_timing.p999,
+      options.budget_ms);
+    return 1;
+  }
+  return 0;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options)
+{
+  if (argc < 2) {
+    return false;
+  }
+  options.command = argv[1];
+  for (int i = 2; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    std::string value = argv[i + 1];
+    if (key == "--dir") {
+      options.dir = value;
+    } else if (key == "--candidates") {
+      options.candidates = std::max(2, std::atoi(value.c_str()));
+    } else if (key == "--keep") {
+      options.keep = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--seed") {
+      options.seed = static_cast<uint32_t>(std::atol(value.c_str()));
+    } else if (key == "--samples") {
+      options.samples = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--budget-ms") {
+      options.budget_ms = std::atof(value.c_str());
+    } else if (key == "--binary-thres") {
+      options.binary_thres = std::atoi(value.c_str());
+    } else if (key == "--enemy-color") {
+      options.enemy_color = std::atoi(value.c_str());
+    } else {
+      std::fprintf(stderr, "Unknown option %s\n", key.c_str());
+      return false;
+    }
+  }
+  return argc % 2 == 0 && (options.command == "search" || options.command == "bench");
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    std::fprintf(stderr, "See the header of detector_worst_case.cpp for usage\n");
+    return 1;
+  }
+  if (options.dir.empty()) {
+    options.dir = rm_vision_bringup::rosHome() + "/detector_worst_case";
+  }
+
+  return options.command == "search" ? search(options) : bench(options);
+}
@@ -0,0 +1,332 @@
+// Copyright 2023 Chen Jun
+
+// Offline Monte-Carlo estimate of the hit rate as a function of pipeline latency mean and jitter.
+//
+// Every trial picks a random instant of a recorded target trajectory, observes the target there
+// with measurement noise, predicts it with constant velocity over the compensated latency plus
+// bullet flight time, and checks whether the bullet lands on the armor plate given the actually
+// sampled latency and the gun dispersion.
+//
+// Usage: latency_hit_simulator [--trajectory t_x_y_z.csv] [--latency stages.csv] [--trials N]
+//          [--threads N] [--bullet-speed m/s] [--dispersion-mrad mrad] [--noise-m m]
+//          [--velocity-window s] [--armor-width m] [--armor-height m]
+//   trajectory: one "t,x,y,z" row per sample (seconds, meters in the odom frame), e.g. exported
+//               from /tracker/target; a synthetic strafing target is used if omitted.
+//   latency:    one row per frame with the latency of every stage in ms (camera, detector,
+//               tracker, serial, gimbal, ...), a header row is skipped. Rows are summed so
+//               correlations between stages are kept. Without it a normal distribution is used.
+
+// STD
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Vec3
+{
+  double x, y, z;
+  Vec3 operator+(const Vec3 & o) const { return {x + o.x, y + o.y, z + o.z}; }
+  Vec3 operator-(const Vec3 & o) const { return {x - o.x, y - o.y, z - o.z}; }
+  Vec3 operator*(double s) const { return {x * s, y * s, z * s}; }
+  double norm() const { return std::sqrt(x * x + y * y + z * z); }
+};
+
+class Trajectory
+{
+public:
+  bool load(const std::string & path)
+  {
+    std::ifstream file(path);
+    for (std::string line; std::getline(file, line);) {
+      std::replace(line.begin(), line.end(), ',', ' ');
+      std::istringstream row(line);
+      double t;
+      Vec3 p;
+      if (row >> t >> p.x >> p.y >> p.z) {
+        times_.push_back(t);
+        points_.push_back(p);
+      }
+    }
+    return times_.size() > 1;
+  }
+
+  // Target strafing 1 m left and right at 4 m, peak speed about 1.6 m/s
+  void makeSynthetic()
+  {
+    for (int i = 0; i <= 60000; i++) {
+      double t = i * 1e-3;
+      times_.push_back(t);
+      points_.push_back({4.0, std::sin(M_PI / 2 * t), 0.1 * std::sin(0.7 * t)});
+    }
+  }
+
+  double begin() const { return times_.front(); }
+  double end() const { return times_.back(); }
+
+  Vec3 at(double t) const
+  {
+    auto it = std::upper_bound(times_.begin(), times_.end(), t);
+    if (it == times_.begin()) {
+      return points_.front();
+    }
+    if (it == times_.end()) {
+      return points_.back();
+    }
+    size_t i = it - times_.begin();
+    double a = (t - times_[i - 1]) / (times_[i] - times_[i - 1]);
+    return points_[i - 1] * (1.0 - a) + points_[i] * a;
+  }
+
+private:
+  std::vector<double> times_;
+  std::vector<Vec3> points_;
+};
+
+struct Options
+{
+  std::string trajectory;
+  std::string latency;
+  long trials = 1000000;
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  double bullet_speed = 15.0;
+  double dispersion_mrad = 3.0;
+  double noise_m = 0.005;
+  double velocity_window = 0.05;
+  double armor_width = 0.135;
+  double armor_height = 0.125;
+};
+
+// Normal sample, or the mean itself for a zero deviation that normal_distribution rejects
+template<typename Rng>
+double gaussian(Rng & rng, double mean, double stddev)
+{
+  return stddev > 0.0 ? std::normal_distribution<double>(mean, stddev)(rng) : mean;
+}
+
+// Latency distribution of one grid cell: the measured samples shifted to a new mean and
+// with their deviation from the mean scaled, or a normal distribution without samples
+struct LatencyModel
+{
+  const std::vector<double> * samples;
+  double sample_mean;
+  double mean;
+  double jitter_scale;
+  double jitter;
+
+  template<typename Rng>
+  double draw(Rng & rng) const
+  {
+    double latency;
+    if (samples && !samples->empty()) {
+      std::uniform_int_distribution<size_t> pick(0, samples->size() - 1);
+      latency = mean + jitter_scale * ((*samples)[pick(rng)] - sample_mean);
+    } else {
+      latency = gaussian(rng, mean, jitter);
+    }
+    return std::max(0.0, latency);
+  }
+};
+
+long simulate(
+  const Trajectory & trajectory, const LatencyModel & latency, const Options & options,
+  long trials, uint32_t seed)
+{
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> instant(
+    trajectory.begin() + options.velocity_window, trajectory.end() - 1.0);
+  auto noise = [&]() {return gaussian(rng, 0.0, options.noise_m);};
+  auto dispersion = [&]() {return gaussian(rng, 0.0, options.dispersion_mrad * 1e-3);};
+
+  long hits = 0;
+  for (long i = 0; i < trials; i++) {
+    double t0 = instant(rng);
+    auto observe = [&](double t) {
+        return trajectory.at(t) + Vec3{noise(), noise(), noise()};
+      };
+    Vec3 p0 = observe(t0);
+    Vec3 p1 = observe(t0 - options.velocity_window);
+    Vec3 velocity = (p0 - p1) * (1.0 / options.velocity_window);
+
+    // The pipeline compensates the mean latency, the jitter around it is not known in advance
+    double flight = p0.norm() / options.bullet_speed;
+    Vec3 aim = p0 + velocity * (latency.mean + flight);
+
+    double actual_latency = latency.draw(rng);
+    double impact_time = t0 + actual_latency + aim.norm() / options.bullet_speed;
+    Vec3 target = trajectory.at(impact_time);
+
+    // Miss distance on the plate, horizontal across the line of sight and vertical
+    Vec3 error = aim - target;
+    double range = target.norm();
+    double horizontal_norm = std::hypot(target.x, target.y);
+    double horizontal = (error.y * target.x - error.x * target.y) / horizontal_norm;
+    horizontal += dispersion() * range;
+    double vertical = error.z + dispersion() * range;
+
+    if (
+      std::abs(horizontal) < options.armor_width / 2 &&
+      std::abs(vertical) < options.armor_height / 2) {
+      hits++;
+    }
+  }
+  return hits;
+}
+
+double hitRate(
+  const Trajectory & trajectory, const LatencyModel & latency, const Options & options)
+{
+  std::vector<std::thread> workers;
+  std::vector<long> hits(options.threads, 0);
+  long per_thread = options.trials / options.threads;
+  for (int i = 0; i < options.threads; i++) {
+    workers.emplace_back([&, i]() {
+      hits[i] = simulate(trajectory, latency, options, per_thread, 12345u + i);
+    });
+  }
+  long total = 0;
+  for (int i = 0; i < options.threads; i++) {
+    workers[i].join();
+    total += hits[i];
+  }
+  return static_cast<double>(total) / (per_thread * options.threads);
+}
+
+std::vector<double> loadLatencySamples(const std::string & path)
+{
+  std::vector<double> samples;
+  std::ifstream file(path);
+  for (std::string line; std::getline(file, line);) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream row(line);
+    double total = 0.0;
+    int stages = 0;
+    for (double stage_ms; row >> stage_ms; stages++) {
+      total += stage_ms;
+    }
+    // Header rows do not parse as numbers
+    if (stages > 0 && row.eof()) {
+      samples.push_back(total * 1e-3);
+    }
+  }
+  return samples;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options)
+{
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    std::string value = argv[i + 1];
+    if (key == "--trajectory") {
+      options.trajectory = value;
+    } else if (key == "--latency") {
+      options.latency = value;
+    } else if (key == "--trials") {
+      options.trials = std::atol(value.c_str());
+    } else if (key == "--threads") {
+      options.threads = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--bullet-speed") {
+      options.bullet_speed = std::atof(value.c_str());
+    } else if (key == "--dispersion-mrad") {
+      options.dispersion_mrad = std::atof(value.c_str());
+    } else if (key == "--noise-m") {
+      options.noise_m = std::atof(value.c_str());
+    } else if (key == "--velocity-window") {
+      options.velocity_window = std::atof(value.c_str());
+    } else if (key == "--armor-width") {
+      options.armor_width = std::atof(value.c_str());
+    } else if (key == "--armor-height") {
+      options.armor_height = std::atof(value.c_str());
+    } else {
+      std::fprintf(stderr, "Unknown option %s\n", key.c_str());
+      return false;
+    }
+  }
+  return argc % 2 == 1;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    std::fprintf(stderr, "See the header of latency_hit_simulator.cpp for usage\n");
+    return 1;
+  }
+  // Every thread runs trials / threads of the trials
+  options.trials = std::max(1L, options.trials);
+  options.threads = static_cast<int>(std::clamp<long>(options.threads, 1, options.trials));
+
+  Trajectory trajectory;
+  if (options.trajectory.empty()) {
+    std::printf("No --trajectory given, using a synthetic strafing target\n");
+    trajectory.makeSynthetic();
+  } else if (!trajectory.load(options.trajectory)) {
+    std::fprintf(stderr, "Failed to load trajectory %s\n", options.trajectory.c_str());
+    return 1;
+  }
+  if (trajectory.end() - trajectory.begin() < 2.0) {
+    std::fprintf(stderr, "Trajectory must be at least 2 s long\n");
+    return 1;
+  }
+
+  std::vector<double> samples;
+  double sample_mean = 0.0;
+  double sample_std = 0.0;
+  if (!options.latency.empty()) {
+    samples = loadLatencySamples(options.latency);
+    if (samples.empty()) {
+      std::fprintf(stderr, "No latency samples in %s\n", options.latency.c_str());
+      return 1;
+    }
+    for (double s : samples) {
+      sample_mean += s / samples.size();
+    }
+    for (double s : samples) {
+      sample_std += (s - sample_mean) * (s - sample_mean) / samples.size();
+    }
+    sample_std = std::sqrt(sample_std);
+    std::printf(
+      "Measured latency: %zu samples, mean %.2f ms, std %.2f ms\n", samples.size(),
+      sample_mean * 1e3, sample_std * 1e3);
+  } else {
+    // Typical values of the current pipeline, from camera exposure to gimbal motion
+    sample_mean = 0.020;
+    sample_std = 0.002;
+  }
+
+  // Grid around the measured point: mean shifted in 2 ms steps, jitter scaled
+  const std::vector<double> mean_offsets_ms = {-8, -6, -4, -2, 0, 2, 4};
+  const std::vector<double> jitter_scales = {0.0, 0.5, 1.0, 1.5, 2.0, 3.0};
+
+  std::printf(
+    "Hit rate in %%, %ld trials per cell on %d threads\n", options.trials, options.threads);
+  std::printf("%10s", "mean\\jit");
+  for (double scale : jitter_scales) {
+    std::printf(" %7.2fms", sample_std * scale * 1e3);
+  }
+  std::printf("\n");
+
+  for (double offset_ms : mean_offsets_ms) {
+    double mean = sample_mean + offset_ms * 1e-3;
+    if (mean < 0.0) {
+      continue;
+    }
+    std::printf("%8.2fms", mean * 1e3);
+    for (double scale : jitter_scales) {
+      LatencyModel model{&samples, sample_mean, mean, scale, sample_std * scale};
+      std::printf(" %9.2f", hitRate(trajectory, model, options) * 100.0);
+      std::fflush(stdout);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,179 @@
+// Copyright 2023 Chen Jun
+
+// Calibrates the detector process layout for this machine: benchmarks the detector's
+// full-frame passes on synthetic 1440x1080 frames for every candidate worker count and
+// pinning, and caches the lowest-latency layout for the bringup (auto_tune in launch_params).
+// Usage: layout_tuner [output], default output $ROS_HOME/rm_vision_tuning.yaml
+
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// OpenCV
+#include <opencv2/core.hpp>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/detector_passes.hpp"
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace
+{
+struct Layout
+{
+  int threads;
+  // CPUs the process is pinned to, empty for no pinning
+  std::vector<int> cpus;
+};
+
+struct Result
+{
+  double p50_ms;
+  double p95_ms;
+  double p99_ms;
+};
+
+std::string cpuList(const std::vector<int> & cpus)
+{
+  std::string list;
+  for (int cpu : cpus) {
+    list += (list.empty() ? "" : ",") + std::to_string(cpu);
+  }
+  return list;
+}
+
+// Runs in a forked child so every layout starts with a fresh OpenCV worker pool
+Result benchmark(const Layout & layout)
+{
+  if (!layout.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : layout.cpus) {
+      CPU_SET(cpu, &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+  cv::setNumThreads(layout.threads);
+
+  std::vector<cv::Mat> frames;
+  for (uint32_t seed = 0; seed < 4; seed++) {
+    frames.push_back(rm_vision_bringup::makeSyntheticFrame(8, 0, seed));
+  }
+
+  auto detector = rm_vision_bringup::makeDetector(80, 0);
+  std::vector<double> times;
+  for (int i = 0; i < 220; i++) {
+    const cv::Mat & frame = frames[i % frames.size()];
+    auto start = std::chrono::steady_clock::now();
+    detector.findLights(frame, detector.preprocessImage(frame));
+    double ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // The first frames spin up the worker pool
+    if (i >= 20) {
+      times.push_back(ms);
+    }
+  }
+
+  std::sort(times.begin(), times.end());
+  auto percentile = [&times](double p) {
+    return times[static_cast<size_t>(p * (times.size() - 1))];
+  };
+  return {percentile(0.5), percentile(0.95), percentile(0.99)};
+}
+
+bool benchmarkInChild(const Layout & layout, Result & result)
+{
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    Result child_result = benchmark(layout);
+    bool ok = write(fds[1], &child_result, sizeof(child_result)) == sizeof(child_result);
+    _exit(ok ? 0 : 1);
+  }
+  close(fds[1]);
+  bool ok = pid > 0 && read(fds[0], &result, sizeof(result)) == sizeof(result);
+  close(fds[0]);
+  if (pid > 0) {
+    waitpid(pid, nullptr, 0);
+  }
+  return ok;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  std::string output;
+  if (argc > 1) {
+    output = argv[1];
+  } else {
+    output = rm_vision_bringup::rosHome() + "/rm_vision_tuning.yaml";
+  }
+
+  // Only the CPUs we are allowed to run on are candidates
+  cpu_set_t allowed_set;
+  sched_getaffinity(0, sizeof(allowed_set), &allowed_set);
+  std::vector<int> allowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed_set)) {
+      allowed.push_back(cpu);
+    }
+  }
+
+  // For every worker count: unpinned, and pinned to the highest CPUs (CPU 0 takes most IRQs)
+  std::vector<Layout> layouts;
+  for (size_t n = 1; n <= allowed.size(); n++) {
+    layouts.push_back({static_cast<int>(n), {}});
+    if (n < allowed.size()) {
+      layouts.push_back({static_cast<int>(n), std::vector<int>(allowed.end() - n, allowed.end())});
+    }
+  }
+
+  std::printf("%-8s %-16s %9s %9s %9s\n", "threads", "cpus", "p50 ms", "p95 ms", "p99 ms");
+  const Layout * best = nullptr;
+  Result best_result{};
+  for (const auto & layout : layouts) {
+    Result result;
+    if (!benchmarkInChild(layout, result)) {
+      std::fprintf(stderr, "Benchmark of %d threads failed\n", layout.threads);
+      continue;
+    }
+    std::printf(
+      "%-8d %-16s %9.3f %9.3f %9.3f\n", layout.threads,
+      layout.cpus.empty() ? "-" : cpuList(layout.cpus).c_str(), result.p50_ms, result.p95_ms,
+      result.p99_ms);
+    // Tail latency decides, the aim loop suffers from outliers more than from the median
+    if (best == nullptr || result.p95_ms < best_result.p95_ms) {
+      best = &layout;
+      best_result = result;
+    }
+  }
+  if (best == nullptr) {
+    return 1;
+  }
+
+  FILE * file = std::fopen(output.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "Failed to write %s\n", output.c_str());
+    return 1;
+  }
+  std::fprintf(file, "# Generated by rm_vision_bringup layout_tuner\n");
+  std::fprintf(file, "cpu_count: %zu\n", allowed.size());
+  std::fprintf(file, "detector_threads: %d\n", best->threads);
+  std::fprintf(file, "detector_cpus: \"%s\"\n", cpuList(best->cpus).c_str());
+  std::fprintf(file, "p95_ms: %.3f\n", best_result.p95_ms);
+  std::fclose(file);
+
+  std::printf(
+    "\nBest: %d threads, cpus \"%s\", written to %s\n", best->threads,
+    cpuList(best->cpus).c_str(), output.c_str());
+  return 0;
+}
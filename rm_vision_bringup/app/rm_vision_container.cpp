@@ -0,0 +1,92 @@
+// Copyright 2023 Chen Jun
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// STD
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/busy_poll_executor.hpp"
+#include "rm_vision_bringup/preload_component_manager.hpp"
+#include "rm_vision_bringup/priority_executor.hpp"
+#include "rm_vision_bringup/thread_utils.hpp"
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = std::make_shared<rm_vision_bringup::PreloadComponentManager>(exec);
+
+  std::thread hot_path_thread;
+  rclcpp::TimerBase::SharedPtr report_timer;
+  if (node->declare_parameter("priority_executor", false)) {
+    auto priority_exec = std::make_shared<rm_vision_bringup::PriorityExecutor>();
+    // "node_name:priority:deadline_ms"
+    for (const auto & entry :
+      node->declare_parameter("node_priorities", std::vector<std::string>{}))
+    {
+      int priority = 0;
+      double deadline_ms = 0.0;
+      char name[256];
+      if (std::sscanf(entry.c_str(), "%255[^:]:%d:%lf", name, &priority, &deadline_ms) < 2) {
+        RCLCPP_ERROR(node->get_logger(), "Invalid node priority \"%s\"", entry.c_str());
+        continue;
+      }
+      priority_exec->setNodePriority(
+        name, priority, std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double, std::milli>(deadline_ms)));
+    }
+    int rt_priority = node->declare_parameter("priority_executor_rt_priority", 0);
+
+    // Same split as busy polling, the manager's services never delay the components
+    node->set_executor(priority_exec);
+    hot_path_thread = std::thread([priority_exec, rt_priority, logger = node->get_logger()]() {
+      if (rt_priority > 0 && !rm_vision_bringup::setCurrentThreadFifo(rt_priority)) {
+        RCLCPP_ERROR(logger, "Failed to set SCHED_FIFO priority %d", rt_priority);
+      }
+      priority_exec->spin();
+    });
+
+    int report_period = node->declare_parameter("priority_executor_report_period", 30);
+    if (report_period > 0) {
+      // Runs on this thread, the counters are atomic
+      report_timer = node->create_wall_timer(
+        std::chrono::seconds(report_period), [priority_exec, logger = node->get_logger()]() {
+          RCLCPP_INFO(logger, "%s", priority_exec->report().c_str());
+        });
+    }
+  } else if (node->declare_parameter("busy_poll", false)) {
+    int cpu = node->declare_parameter("busy_poll_cpu", -1);
+    int spin_window_us = node->declare_parameter("busy_poll_spin_window_us", 2000);
+    if (cpu < 0) {
+      RCLCPP_WARN(node->get_logger(), "busy_poll_cpu not set, polling competes with other threads");
+    }
+
+    // Components run on the polling thread while load requests stay on this thread,
+    // so threads spawned by component constructors do not inherit the pinned affinity
+    auto busy_exec = std::make_shared<rm_vision_bringup::BusyPollExecutor>(
+      std::chrono::microseconds(spin_window_us));
+    node->set_executor(busy_exec);
+    hot_path_thread = std::thread([busy_exec, cpu, logger = node->get_logger()]() {
+      if (cpu >= 0 && !rm_vision_bringup::pinCurrentThread(cpu)) {
+        RCLCPP_ERROR(logger, "Failed to pin the polling thread to CPU %d", cpu);
+      }
+      busy_exec->spin();
+    });
+  }
+
+  exec->add_node(node);
+  exec->spin();
+
+  rclcpp::shutdown();
+  if (hot_path_thread.joinable()) {
+    hot_path_thread.join();
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+// Copyright 2023 Chen Jun
+
+// Measures the latency from an intra-process publish to the start of the subscription
+// callback and the CPU time of the spinning thread, with the blocking SingleThreadedExecutor,
+// with BusyPollExecutor polling all the time and with a bounded spin window.
+// Usage: wakeup_latency_benchmark [cpu] [samples] [spin_window_us]
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <std_msgs/msg/int64.hpp>
+
+// Linux
+#include <time.h>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/busy_poll_executor.hpp"
+#include "rm_vision_bringup/thread_utils.hpp"
+
+namespace
+{
+int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+int64_t threadCpuNs()
+{
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+struct Result
+{
+  std::vector<double> latencies_us;
+  // CPU time of the spinning thread over its wall time
+  double cpu_percent = 0.0;
+};
+
+Result measure(std::shared_ptr<rclcpp::Executor> exec, int cpu, int samples)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "wakeup_latency_benchmark", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  Result result;
+  result.latencies_us.reserve(samples);
+  auto sub = node->create_subscription<std_msgs::msg::Int64>(
+    "wakeup", 10, [&result](std_msgs::msg::Int64::UniquePtr msg) {
+      result.latencies_us.push_back((nowNs() - msg->data) / 1e3);
+    });
+  auto pub = node->create_publisher<std_msgs::msg::Int64>("wakeup", 10);
+
+  exec->add_node(node);
+  std::thread spin_thread([exec, cpu, &result]() {
+    if (cpu >= 0) {
+      rm_vision_bringup::pinCurrentThread(cpu);
+    }
+    int64_t wall_start = nowNs();
+    int64_t cpu_start = threadCpuNs();
+    exec->spin();
+    result.cpu_percent = 100.0 * (threadCpuNs() - cpu_start) / (nowNs() - wall_start);
+  });
+
+  // Irregular period so the subscriber cannot be in phase with the publisher
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> period_us(500, 1500);
+  for (int i = 0; i < samples && rclcpp::ok(); i++) {
+    std::this_thread::sleep_for(std::chrono::microseconds(period_us(rng)));
+    auto msg = std::make_unique<std_msgs::msg::Int64>();
+    msg->data = nowNs();
+    pub->publish(std::move(msg));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  exec->cancel();
+  spin_thread.join();
+  exec->remove_node(node);
+  return result;
+}
+
+void printRow(const std::string & name, Result result)
+{
+  auto & latencies_us = result.latencies_us;
+  if (latencies_us.empty()) {
+    std::printf("%-10s no samples\n", name.c_str());
+    return;
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  auto percentile = [&latencies_us](double p) {
+    return latencies_us[static_cast<size_t>(p * (latencies_us.size() - 1))];
+  };
+  std::printf(
+    "%-10s %8zu %9.1f %9.1f %9.1f %9.1f %6.1f\n", name.c_str(), latencies_us.size(),
+    percentile(0.5), percentile(0.9), percentile(0.99), latencies_us.back(), result.cpu_percent);
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  auto args = rclcpp::remove_ros_arguments(argc, argv);
+  int cpu = args.size() > 1 ? std::atoi(args[1].c_str()) : -1;
+  int samples = args.size() > 2 ? std::atoi(args[2].c_str()) : 5000;
+  int spin_window_us = args.size() > 3 ? std::atoi(args[3].c_str()) : 200;
+
+  auto blocking_exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  // Longer than any publish period, so it never blocks
+  auto busy_exec = std::make_shared<rm_vision_bringup::BusyPollExecutor>(std::chrono::seconds(1));
+  auto window_exec = std::make_shared<rm_vision_bringup::BusyPollExecutor>(
+    std::chrono::microseconds(spin_window_us));
+  auto blocking = measure(blocking_exec, cpu, samples);
+  auto busy = measure(busy_exec, cpu, samples);
+  auto window = measure(window_exec, cpu, samples);
+
+  std::printf("Wake-up latency in us, subscriber on CPU %d\n", cpu);
+  std::printf(
+    "%-10s %8s %9s %9s %9s %9s %6s\n", "mode", "samples", "p50", "p90", "p99", "max", "cpu%");
+  printRow("blocking", blocking);
+  printRow("busy_poll", busy);
+  printRow("window_" + std::to_string(spin_window_us), window);
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,35 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__BUSY_POLL_EXECUTOR_HPP_
+#define RM_VISION_BRINGUP__BUSY_POLL_EXECUTOR_HPP_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// STD
+#include <chrono>
+
+namespace rm_vision_bringup
+{
+// Single-threaded executor that polls the wait set without blocking instead of sleeping
+// on a futex until work arrives. Meant for a thread pinned to an isolated core. After each
+// callback it polls for at most spin_window, which catches the callbacks chained to it (the
+// detector after the camera) and, if the window covers the frame period, the next frame. When
+// the window passes without work it falls back to a blocking wait, so the core is busy for at
+// most one window per callback burst instead of all the time while frames arrive.
+class BusyPollExecutor : public rclcpp::executors::SingleThreadedExecutor
+{
+public:
+  explicit BusyPollExecutor(
+    std::chrono::nanoseconds spin_window,
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions());
+
+  void spin() override;
+
+private:
+  std::chrono::nanoseconds spin_window_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__BUSY_POLL_EXECUTOR_HPP_
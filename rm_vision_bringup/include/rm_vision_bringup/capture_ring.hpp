@@ -0,0 +1,77 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__CAPTURE_RING_HPP_
+#define RM_VISION_BRINGUP__CAPTURE_RING_HPP_
+
+// STD
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// Append-only ring of timestamped byte records in a memory-mapped file.
+// Records reach the page cache as soon as they are written, so the capture survives a crash
+// of the writer. Layout (little endian), decoded by scripts/serial_capture_decode.py:
+//   RingHeader, then `capacity` bytes of data holding 8-byte aligned records,
+//   each a RecordHeader followed by `length` payload bytes.
+class CaptureRing
+{
+public:
+  static constexpr char kMagic[8] = {'R', 'M', 'S', 'C', 'A', 'P', '1', '\0'};
+  static constexpr uint16_t kSync = 0x5AA5;
+
+  struct RingHeader
+  {
+    char magic[8];
+    uint64_t capacity;
+    // Total bytes ever written, the next record starts at write_pos % capacity
+    std::atomic<uint64_t> write_pos;
+    // Highest end of a record the writer started, ahead of write_pos while a record is being
+    // written (or was torn by a crash). Bytes before claim_pos - capacity may be overwritten.
+    std::atomic<uint64_t> claim_pos;
+    uint64_t reserved[4];
+  };
+
+  struct RecordHeader
+  {
+    uint16_t sync;
+    uint8_t direction;
+    uint8_t reserved;
+    uint32_t length;
+    int64_t stamp_ns;
+  };
+
+  CaptureRing() = default;
+  ~CaptureRing();
+
+  CaptureRing(const CaptureRing &) = delete;
+  CaptureRing & operator=(const CaptureRing &) = delete;
+
+  // Maps the file, keeping previous records if it already holds a ring of the same capacity
+  bool open(const std::string & path, size_t capacity);
+
+  void append(uint8_t direction, int64_t stamp_ns, const uint8_t * data, uint32_t length);
+
+  // Copies the newest bytes, at most max_bytes, of a ring written by another process.
+  // start is the ring position of bytes[0], which may fall inside a record.
+  static bool readTail(
+    const std::string & path, size_t max_bytes, uint64_t & start, std::vector<uint8_t> & bytes);
+
+private:
+  void write(uint64_t pos, const void * src, size_t size);
+
+  int fd_ = -1;
+  size_t mapped_size_ = 0;
+  RingHeader * header_ = nullptr;
+  uint8_t * data_ = nullptr;
+};
+
+static_assert(sizeof(CaptureRing::RingHeader) == 64, "RingHeader layout");
+static_assert(sizeof(CaptureRing::RecordHeader) == 16, "RecordHeader layout");
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__CAPTURE_RING_HPP_
@@ -0,0 +1,59 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__DETECTOR_PASSES_HPP_
+#define RM_VISION_BRINGUP__DETECTOR_PASSES_HPP_
+
+// OpenCV
+#include <opencv2/core.hpp>
+
+// STD
+#include <cstddef>
+#include <cstdint>
+
+#include "armor_detector/detector.hpp"
+
+namespace rm_vision_bringup
+{
+// Synthetic frames and rm_auto_aim's Detector, so the cost of its passes can be measured
+// without a camera or the ROS graph. The number classifier is not included.
+
+constexpr int kFrameWidth = 1440;
+constexpr int kFrameHeight = 1080;
+
+// 0: red, 1: blue, same as the detector's detect_color
+cv::Mat makeSyntheticFrame(int light_pairs, int enemy_color, uint32_t seed);
+
+// Parameters of frames synthesized to make the detector slow
+struct StressFrameParams
+{
+  // Light-like bars, placed in rows so that neighbours pair up as armors
+  int lights = 64;
+  float light_length = 40.f;
+  // Distance between neighbouring bars in bar lengths, 0.8-3.2 is a small armor
+  float pair_spacing = 2.f;
+  // Fraction of the bars in the enemy color, only those are matched
+  float enemy_fraction = 1.f;
+  // Blurred background noise around binary_thres gives many blob contours
+  float noise_mean = 40.f;
+  float noise_amplitude = 40.f;
+  int noise_blur = 1;
+};
+
+cv::Mat makeStressFrame(const StressFrameParams & params, int enemy_color, uint32_t seed);
+
+// rm_auto_aim's Detector with the parameters ArmorDetectorNode is deployed with
+rm_auto_aim::Detector makeDetector(int binary_thres, int enemy_color);
+
+struct Detection
+{
+  size_t lights;
+  size_t armors;
+};
+
+// preprocessImage, findLights and matchLights of the detector, everything detect() runs
+// before the number classifier
+Detection detectFrame(rm_auto_aim::Detector & detector, const cv::Mat & rgb);
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__DETECTOR_PASSES_HPP_
@@ -0,0 +1,45 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__FRAME_RECEIVER_NODE_HPP_
+#define RM_VISION_BRINGUP__FRAME_RECEIVER_NODE_HPP_
+
+// ROS
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+#include "rm_vision_bringup/stage_stats.hpp"
+
+namespace rm_vision_bringup
+{
+// Detector host side of offloaded detection: decodes the frames of FrameSenderNode into
+// /image_raw for the detector in the same container, dropping frames older than max_age_ms.
+// ~/latency reports the frame age on arrival and once decoded, measured from the capture
+// stamp, which requires the clocks of both hosts to be synchronized (chrony or PTP).
+class FrameReceiverNode : public rclcpp::Node
+{
+public:
+  explicit FrameReceiverNode(const rclcpp::NodeOptions & options);
+
+private:
+  void compressedCallback(const sensor_msgs::msg::CompressedImage::ConstSharedPtr msg);
+
+  void publishStats();
+
+  double max_age_ms_;
+
+  int stale_frames_ = 0;
+  StageStats arrival_age_ms_;
+  StageStats decode_ms_;
+  StageStats ready_age_ms_;
+
+  rclcpp::Subscription<sensor_msgs::msg::CompressedImage>::SharedPtr compressed_sub_;
+  rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr image_pub_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr stats_pub_;
+  rclcpp::TimerBase::SharedPtr stats_timer_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__FRAME_RECEIVER_NODE_HPP_
@@ -0,0 +1,55 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__FRAME_SENDER_NODE_HPP_
+#define RM_VISION_BRINGUP__FRAME_SENDER_NODE_HPP_
+
+// OpenCV
+#include <opencv2/core.hpp>
+
+// ROS
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+// STD
+#include <vector>
+
+#include "rm_vision_bringup/stage_stats.hpp"
+
+namespace rm_vision_bringup
+{
+// Camera host side of offloaded detection: JPEG-encodes the frames of the camera in the same
+// container, optionally cropped to a fixed ROI, and publishes them with the capture stamp.
+// The camera info is republished with the principal point moved into the ROI.
+// Every hop keeps only the newest frame, so a frame that cannot be sent in time is dropped.
+class FrameSenderNode : public rclcpp::Node
+{
+public:
+  explicit FrameSenderNode(const rclcpp::NodeOptions & options);
+
+private:
+  void imageCallback(const sensor_msgs::msg::Image::ConstSharedPtr msg);
+
+  void cameraInfoCallback(const sensor_msgs::msg::CameraInfo::ConstSharedPtr msg);
+
+  void publishStats();
+
+  std::vector<int> encode_params_;
+  cv::Rect roi_;
+
+  StageStats encode_ms_;
+  StageStats frame_kb_;
+
+  rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr image_sub_;
+  rclcpp::Subscription<sensor_msgs::msg::CameraInfo>::SharedPtr camera_info_sub_;
+  rclcpp::Publisher<sensor_msgs::msg::CompressedImage>::SharedPtr compressed_pub_;
+  rclcpp::Publisher<sensor_msgs::msg::CameraInfo>::SharedPtr camera_info_pub_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr stats_pub_;
+  rclcpp::TimerBase::SharedPtr stats_timer_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__FRAME_SENDER_NODE_HPP_
@@ -0,0 +1,53 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__LATENCY_PROBE_NODE_HPP_
+#define RM_VISION_BRINGUP__LATENCY_PROBE_NODE_HPP_
+
+// ROS
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+// STD
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// cyclictest-style probe: a thread sleeps until absolute deadlines and records how late it
+// wakes up. Running it with the priority and affinity of the hot-path threads shows the
+// scheduling noise those threads see, independent of the algorithm time.
+class LatencyProbeNode : public rclcpp::Node
+{
+public:
+  explicit LatencyProbeNode(const rclcpp::NodeOptions & options);
+
+  ~LatencyProbeNode() override;
+
+private:
+  void probeLoop();
+
+  void publishHistogram();
+
+  int interval_us_;
+  int cpu_;
+  int priority_;
+  int bin_width_us_;
+
+  // Written by the probe thread, drained by the publish timer
+  std::vector<std::atomic<uint64_t>> bins_;
+  std::atomic<int64_t> max_latency_ns_{0};
+  // Periods skipped because a wake-up came later than the next deadline
+  std::atomic<uint64_t> overruns_{0};
+
+  std::atomic<bool> running_{true};
+  std::thread probe_thread_;
+
+  rclcpp::TimerBase::SharedPtr publish_timer_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr histogram_pub_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__LATENCY_PROBE_NODE_HPP_
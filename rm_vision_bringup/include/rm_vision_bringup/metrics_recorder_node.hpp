@@ -0,0 +1,84 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__METRICS_RECORDER_NODE_HPP_
+#define RM_VISION_BRINGUP__METRICS_RECORDER_NODE_HPP_
+
+// ROS
+#include <auto_aim_interfaces/msg/armors.hpp>
+#include <auto_aim_interfaces/msg/target.hpp>
+#include <auto_aim_interfaces/msg/tracker_info.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+// STD
+#include <cstdint>
+#include <vector>
+
+#include "rm_vision_bringup/capture_ring.hpp"
+#include "rm_vision_bringup/stage_stats.hpp"
+
+namespace rm_vision_bringup
+{
+// One record per period, the payload of a CaptureRing record.
+// Decoded by scripts/metrics_query.py, append fields at the end only.
+struct MetricsRecord
+{
+  // Age of the frames (from the capture stamp) when the detector and tracker results arrive
+  float detector_age_mean_ms;
+  float detector_age_max_ms;
+  float tracker_age_mean_ms;
+  float tracker_age_max_ms;
+  // Camera frames (one camera info each) and detector outputs, the difference is dropped
+  uint32_t frames;
+  uint32_t detections;
+  uint32_t armors;
+  // Fraction of tracker outputs in tracking state, mean innovation of the tracker
+  float tracking_ratio;
+  float position_diff_mean;
+  float yaw_diff_mean;
+  float cpu_busy_ratio;
+  float max_temperature;
+  float cpu_frequency_mhz;
+  // 99th percentile of the detector ages in the period
+  float detector_age_p99_ms;
+};
+
+// Aggregates pipeline metrics and appends them once per period to a memory-mapped ring file,
+// so the history of the last days survives crashes and reboots and the oldest records are
+// overwritten once ring_size_mb is reached. Runs in its own process, off the hot path.
+class MetricsRecorderNode : public rclcpp::Node
+{
+public:
+  explicit MetricsRecorderNode(const rclcpp::NodeOptions & options);
+
+private:
+  void flush();
+
+  double ageMs(const builtin_interfaces::msg::Time & stamp);
+
+  CaptureRing ring_;
+
+  StageStats detector_age_ms_;
+  // Every detector age of the period for its percentile, the capacity is kept across periods
+  std::vector<float> detector_ages_ms_;
+  StageStats tracker_age_ms_;
+  StageStats position_diff_;
+  StageStats yaw_diff_;
+  uint32_t frames_ = 0;
+  uint32_t armors_ = 0;
+  uint32_t tracking_ = 0;
+  uint64_t last_cpu_busy_ = 0;
+  uint64_t last_cpu_total_ = 0;
+
+  rclcpp::Subscription<sensor_msgs::msg::CameraInfo>::SharedPtr camera_info_sub_;
+  rclcpp::Subscription<auto_aim_interfaces::msg::Armors>::SharedPtr armors_sub_;
+  rclcpp::Subscription<auto_aim_interfaces::msg::Target>::SharedPtr target_sub_;
+  rclcpp::Subscription<auto_aim_interfaces::msg::TrackerInfo>::SharedPtr tracker_info_sub_;
+  rclcpp::TimerBase::SharedPtr flush_timer_;
+};
+
+static_assert(sizeof(MetricsRecord) == 56, "MetricsRecord layout");
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__METRICS_RECORDER_NODE_HPP_
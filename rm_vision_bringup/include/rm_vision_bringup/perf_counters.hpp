@@ -0,0 +1,42 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__PERF_COUNTERS_HPP_
+#define RM_VISION_BRINGUP__PERF_COUNTERS_HPP_
+
+// STD
+#include <array>
+#include <cstdint>
+
+namespace rm_vision_bringup
+{
+// User-space hardware counters of one thread (any process), read as a single perf_event group
+class PerfCounterGroup
+{
+public:
+  struct Values
+  {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+  };
+
+  PerfCounterGroup() = default;
+  ~PerfCounterGroup();
+
+  PerfCounterGroup(const PerfCounterGroup &) = delete;
+  PerfCounterGroup & operator=(const PerfCounterGroup &) = delete;
+
+  // Returns false with errno set if counters are not supported or not permitted
+  // (no PMU in a VM, perf_event_paranoid, missing CAP_PERFMON)
+  bool open(int tid);
+
+  bool read(Values & values) const;
+
+private:
+  std::array<int, 4> fds_{{-1, -1, -1, -1}};
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__PERF_COUNTERS_HPP_
@@ -0,0 +1,35 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__PRELOAD_COMPONENT_MANAGER_HPP_
+#define RM_VISION_BRINGUP__PRELOAD_COMPONENT_MANAGER_HPP_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_components/component_manager.hpp>
+
+// STD
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// Component manager that dlopens the libraries of the known plugins while the container starts,
+// so that the later load_node requests only construct the nodes.
+// Together with LD_BIND_NOW=1 all symbols are bound before the first frame arrives.
+class PreloadComponentManager : public rclcpp_components::ComponentManager
+{
+public:
+  explicit PreloadComponentManager(
+    std::weak_ptr<rclcpp::Executor> executor, std::string node_name = "ComponentManager",
+    const rclcpp::NodeOptions & node_options = rclcpp::NodeOptions()
+                                                 .start_parameter_services(false)
+                                                 .start_parameter_event_publisher(false));
+
+private:
+  void preload(const std::vector<std::string> & packages);
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__PRELOAD_COMPONENT_MANAGER_HPP_
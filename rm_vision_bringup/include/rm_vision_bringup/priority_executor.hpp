@@ -0,0 +1,88 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__PRIORITY_EXECUTOR_HPP_
+#define RM_VISION_BRINGUP__PRIORITY_EXECUTOR_HPP_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// Single-threaded executor that looks for work again after every callback and always runs
+// a ready callback of the node with the highest priority, so the hot path waits behind at most
+// the one housekeeping callback already running (callbacks are not preempted).
+// The response time of a callback is counted from the first look for work that found it ready
+// to its end: the time spent behind other callbacks plus its own run time, but not the run time
+// of the callback during which its message arrived. Callbacks that exceed the deadline of their
+// node are counted as misses.
+class PriorityExecutor : public rclcpp::executors::SingleThreadedExecutor
+{
+public:
+  explicit PriorityExecutor(const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions());
+
+  // Call before spinning. Nodes without a priority run last and have no deadline.
+  void setNodePriority(
+    const std::string & node_name, int priority, std::chrono::nanoseconds deadline);
+
+  void spin() override;
+
+  // One line per node with a priority: callbacks executed, deadlines missed, worst response
+  std::string report() const;
+
+private:
+  using GroupMap = rclcpp::memory_strategy::MemoryStrategy::WeakCallbackGroupsToNodesMap;
+  using ReadyList = std::vector<std::pair<const void *, std::chrono::steady_clock::time_point>>;
+
+  struct NodeStats
+  {
+    int priority = 0;
+    std::chrono::nanoseconds deadline{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> missed{0};
+    std::atomic<int64_t> worst_ns{0};
+  };
+
+  // Rebuilds the callback groups per priority level when nodes were added or removed
+  void updateLevels();
+
+  // Call after every wait for work. Keeps when each ready entity was first seen ready
+  // and finds the highest level with ready work.
+  void markReady(std::chrono::steady_clock::time_point now);
+
+  ReadyList::iterator findReady(const void * entity);
+
+  bool getNextByPriority(rclcpp::AnyExecutable & any_executable);
+
+  // `looked` is the look for work that picked the executable, used when it was not seen ready
+  void record(
+    const rclcpp::AnyExecutable & any_executable, std::chrono::steady_clock::time_point looked);
+
+  // std::map keeps the atomics in place
+  std::map<std::string, NodeStats> nodes_;
+
+  // Highest priority first
+  std::vector<std::pair<int, GroupMap>> levels_;
+  size_t levels_group_count_ = 0;
+  // Index in levels_ of the highest level with ready work at the last look, size if none
+  size_t ready_level_ = 0;
+
+  // Subscription, timer, service, client or waitable and when it was first seen ready.
+  // A handful of entries, searched linearly and reused so a look for work does not allocate.
+  ReadyList ready_since_;
+  ReadyList ready_scratch_;
+  // rcl handles left in the wait set by the last wait
+  std::vector<const void *> ready_handles_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__PRIORITY_EXECUTOR_HPP_
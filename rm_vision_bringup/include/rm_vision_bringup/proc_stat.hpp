@@ -0,0 +1,67 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__PROC_STAT_HPP_
+#define RM_VISION_BRINGUP__PROC_STAT_HPP_
+
+// STD
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+struct ThreadSample
+{
+  int pid = 0;
+  int tid = 0;
+  std::string process;
+  std::string name;
+
+  // Last CPU the thread ran on and the CPUs it is allowed to run on
+  int processor = -1;
+  std::string cpus_allowed;
+
+  int policy = 0;
+  int rt_priority = 0;
+  int nice = 0;
+
+  // From /proc/<pid>/task/<tid>/schedstat
+  uint64_t cpu_time_ns = 0;
+  uint64_t run_delay_ns = 0;
+  uint64_t timeslices = 0;
+
+  uint64_t voluntary_ctxt_switches = 0;
+  uint64_t nonvoluntary_ctxt_switches = 0;
+};
+
+// Find processes whose executable basename or ROS node name (__node:=) is in names
+std::vector<int> findProcesses(const std::vector<std::string> & names);
+
+// Process label used in reports: ROS node name if remapped, executable basename otherwise
+std::string processLabel(int pid);
+
+std::vector<int> listThreads(int pid);
+
+int parentPid(int pid);
+
+// Wall-clock time the process was started, in seconds since epoch, with the resolution of
+// one clock tick (10 ms at CLK_TCK 100)
+double processStartTime(int pid);
+
+// Returns false if the thread has exited in the meantime
+bool readThreadSample(int pid, int tid, ThreadSample & sample);
+
+std::string policyName(int policy);
+
+// System-wide CPU time from /proc/stat in clock ticks, busy is everything but idle and iowait
+bool readCpuTimes(uint64_t & busy, uint64_t & total);
+
+// Highest temperature of all thermal zones in degrees Celsius, NaN if none is readable
+double maxTemperature();
+
+// Mean current frequency of all CPUs in MHz, drops when the CPU throttles; NaN if unknown
+double meanCpuFrequencyMhz();
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__PROC_STAT_HPP_
@@ -0,0 +1,16 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__ROS_HOME_HPP_
+#define RM_VISION_BRINGUP__ROS_HOME_HPP_
+
+// STD
+#include <string>
+
+namespace rm_vision_bringup
+{
+// $ROS_HOME, or ~/.ros like the rest of ROS (/tmp/.ros without HOME)
+std::string rosHome();
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__ROS_HOME_HPP_
@@ -0,0 +1,61 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__SAMPLING_PROFILER_HPP_
+#define RM_VISION_BRINGUP__SAMPLING_PROFILER_HPP_
+
+// STD
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// In-process stack sampler: ITIMER_PROF raises SIGPROF on the thread that is consuming CPU,
+// the handler unwinds that thread's stack into a buffer allocated before the timer is armed.
+// SIGPROF and the timer are process-wide, so only one profiler can run at a time.
+class SamplingProfiler
+{
+public:
+  SamplingProfiler() = default;
+  ~SamplingProfiler();
+
+  SamplingProfiler(const SamplingProfiler &) = delete;
+  SamplingProfiler & operator=(const SamplingProfiler &) = delete;
+
+  // Samples at frequency Hz of process CPU time until max_samples are taken.
+  // Returns false if any profiler of this process is already running.
+  bool start(int frequency, size_t max_samples);
+
+  // Disarms the timer and waits for samples in flight
+  void stop();
+
+  bool running() const { return running_; }
+
+  // Aggregates the samples into "thread;outermost;...;innermost count" lines for flamegraph.pl
+  // or speedscope. Only threads whose name contains one of the filters are kept (all if empty).
+  // Returns the number of samples written, -1 if the file cannot be opened.
+  long writeCollapsed(const std::string & path, const std::vector<std::string> & threads) const;
+
+  size_t dropped() const;
+
+private:
+  static constexpr int kMaxDepth = 48;
+
+  struct Sample
+  {
+    int tid;
+    int depth;
+    void * frames[kMaxDepth];
+  };
+
+  static void handleSignal(int signal);
+
+  std::vector<Sample> samples_;
+  std::atomic<size_t> next_{0};
+  bool running_ = false;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__SAMPLING_PROFILER_HPP_
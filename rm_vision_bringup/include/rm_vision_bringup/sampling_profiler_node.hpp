@@ -0,0 +1,50 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__SAMPLING_PROFILER_NODE_HPP_
+#define RM_VISION_BRINGUP__SAMPLING_PROFILER_NODE_HPP_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <std_srvs/srv/trigger.hpp>
+
+// STD
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/sampling_profiler.hpp"
+
+namespace rm_vision_bringup
+{
+// Profiles the process it is loaded into: ~/start samples all threads for `duration` seconds
+// (or until ~/stop) and writes a collapsed-stack file to output_dir for flame graphs.
+// Idle until started, so it can stay loaded in the containers during matches.
+class SamplingProfilerNode : public rclcpp::Node
+{
+public:
+  explicit SamplingProfilerNode(const rclcpp::NodeOptions & options);
+
+private:
+  void startCallback(
+    const std_srvs::srv::Trigger::Request::SharedPtr request,
+    std_srvs::srv::Trigger::Response::SharedPtr response);
+
+  void stopCallback(
+    const std_srvs::srv::Trigger::Request::SharedPtr request,
+    std_srvs::srv::Trigger::Response::SharedPtr response);
+
+  // Returns the result message
+  std::string finish();
+
+  std::string output_dir_;
+  std::string output_file_;
+
+  SamplingProfiler profiler_;
+
+  rclcpp::TimerBase::SharedPtr stop_timer_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr start_srv_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr stop_srv_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__SAMPLING_PROFILER_NODE_HPP_
@@ -0,0 +1,44 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__SERIAL_CAPTURE_NODE_HPP_
+#define RM_VISION_BRINGUP__SERIAL_CAPTURE_NODE_HPP_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// STD
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "rm_vision_bringup/capture_ring.hpp"
+
+namespace rm_vision_bringup
+{
+// Captures the raw bytes exchanged with the MCU over the USB CDC serial device from usbmon,
+// without touching the serial driver, into a crash-safe CaptureRing file.
+// Requires the usbmon module and access to /dev/usbmon* (the runtime container is privileged).
+class SerialCaptureNode : public rclcpp::Node
+{
+public:
+  explicit SerialCaptureNode(const rclcpp::NodeOptions & options);
+
+  ~SerialCaptureNode() override;
+
+private:
+  // Bus and device number of the USB device behind device_name_, false if not present
+  bool resolveDevice(int & busnum, int & devnum) const;
+
+  void captureLoop();
+
+  std::string device_name_;
+  CaptureRing ring_;
+
+  std::atomic<bool> running_{true};
+  std::thread capture_thread_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__SERIAL_CAPTURE_NODE_HPP_
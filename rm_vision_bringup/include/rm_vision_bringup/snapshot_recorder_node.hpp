@@ -0,0 +1,89 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__SNAPSHOT_RECORDER_NODE_HPP_
+#define RM_VISION_BRINGUP__SNAPSHOT_RECORDER_NODE_HPP_
+
+// ROS
+#include <rcl_interfaces/msg/parameter_event.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <std_srvs/srv/trigger.hpp>
+
+// STD
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// Keeps the last `depth` serialized messages of every pipeline topic and the current value of
+// every parameter in the graph, in its own process so the hot path never waits on it.
+// ~/dump writes them together with the tail of the serial capture ring to a timestamped file,
+// decode with scripts/snapshot_decode.py. File layout (little endian):
+//   "RMSNAP1\0", int64 wall stamp ns, then sections until the end of the file:
+//   u8 kTopicSection, str name, str type, u32 count, count x (int64 stamp ns, u32 size, CDR)
+//   u8 kParameterSection, str node, u32 count, count x (str name, str value)
+//   u8 kSerialSection, u64 ring position, u32 size, bytes of the serial capture ring
+// where str is a u16 length followed by the characters.
+class SnapshotRecorderNode : public rclcpp::Node
+{
+public:
+  static constexpr uint8_t kTopicSection = 1;
+  static constexpr uint8_t kParameterSection = 2;
+  static constexpr uint8_t kSerialSection = 3;
+
+  explicit SnapshotRecorderNode(const rclcpp::NodeOptions & options);
+
+private:
+  // Fixed number of slots, each keeps its capacity once grown to the message size
+  struct TopicRing
+  {
+    std::string type;
+    std::vector<int64_t> stamps;
+    std::vector<std::vector<uint8_t>> messages;
+    size_t next = 0;
+    size_t count = 0;
+    rclcpp::GenericSubscription::SharedPtr sub;
+  };
+
+  void discoverTopics();
+
+  // Fetches the full parameter set of every node that appeared since the last call,
+  // parameter events only carry the changes after that
+  void discoverNodes();
+
+  void fetchParameters(
+    const std::string & node_name, const rclcpp::AsyncParametersClient::SharedPtr & client);
+
+  void parameterEventCallback(const rcl_interfaces::msg::ParameterEvent::SharedPtr event);
+
+  void dumpCallback(
+    const std_srvs::srv::Trigger::Request::SharedPtr request,
+    std_srvs::srv::Trigger::Response::SharedPtr response);
+
+  std::vector<std::string> topics_;
+  int depth_;
+  std::string output_dir_;
+  std::string serial_ring_file_;
+  int serial_bytes_;
+
+  // All callbacks run on the executor of this node, a dump sees every ring at the same instant
+  std::map<std::string, TopicRing> rings_;
+  // Node name -> parameter name -> value
+  std::map<std::string, std::map<std::string, std::string>> parameters_;
+  // One client per live node, kept while its parameter services are not up (or never will be)
+  std::map<std::string, rclcpp::AsyncParametersClient::SharedPtr> parameter_clients_;
+  // Live nodes whose parameters were requested
+  std::set<std::string> fetched_nodes_;
+  // Node name -> parameters changed by events since the fetch was sent, newer than its result
+  std::map<std::string, std::set<std::string>> changed_since_fetch_;
+
+  rclcpp::TimerBase::SharedPtr discover_timer_;
+  rclcpp::Subscription<rcl_interfaces::msg::ParameterEvent>::SharedPtr parameter_event_sub_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr dump_srv_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__SNAPSHOT_RECORDER_NODE_HPP_
@@ -0,0 +1,31 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__STAGE_STATS_HPP_
+#define RM_VISION_BRINGUP__STAGE_STATS_HPP_
+
+// ROS
+#include <diagnostic_msgs/msg/diagnostic_status.hpp>
+
+// STD
+#include <string>
+
+namespace rm_vision_bringup
+{
+// Running mean and max of one pipeline stage, reported and reset periodically
+struct StageStats
+{
+  int count = 0;
+  double sum = 0.0;
+  double max = 0.0;
+
+  void add(double value);
+
+  double mean() const { return count > 0 ? sum / count : 0.0; }
+
+  // Appends <name>_mean and <name>_max to the status and resets
+  void report(diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & name);
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__STAGE_STATS_HPP_
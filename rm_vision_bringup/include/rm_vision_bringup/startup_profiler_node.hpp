@@ -0,0 +1,72 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__STARTUP_PROFILER_NODE_HPP_
+#define RM_VISION_BRINGUP__STARTUP_PROFILER_NODE_HPP_
+
+// ROS
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+// STD
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+// Records when every startup phase of the bringup is first observed:
+// process spawn (from /proc), node appearing in the graph, topic advertised
+// (constructor finished its initialization) and first message on the topic.
+// Every run is appended to a history file. With the last time the previous run was seen
+// alive, this gives the restart-to-ready time after a crash with --restart always.
+// A run counts as a restart only if it was launched within max_restart_gap of that time.
+class StartupProfilerNode : public rclcpp::Node
+{
+public:
+  explicit StartupProfilerNode(const rclcpp::NodeOptions & options);
+
+private:
+  struct Event
+  {
+    double time;
+    std::string label;
+  };
+
+  void poll();
+
+  void record(const std::string & label, double time);
+
+  void finish();
+
+  void heartbeat();
+
+  // Appends this run and returns the median ready time of the previous runs, 0 if none
+  double appendHistory(double ready_time, double restart_time);
+
+  std::vector<std::string> processes_;
+  std::vector<std::string> nodes_;
+  std::vector<std::string> topics_;
+  double timeout_;
+  double max_restart_gap_;
+  std::string history_file_;
+  std::string alive_file_;
+
+  double launch_time_;
+  // Wall time the previous run was last seen alive (1 s resolution), 0 if unknown
+  double previous_alive_ = 0.0;
+  std::vector<Event> events_;
+  std::set<std::string> recorded_;
+  std::set<std::string> received_topics_;
+
+  std::map<std::string, rclcpp::GenericSubscription::SharedPtr> topic_subs_;
+
+  rclcpp::TimerBase::SharedPtr poll_timer_;
+  rclcpp::TimerBase::SharedPtr heartbeat_timer_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr report_pub_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__STARTUP_PROFILER_NODE_HPP_
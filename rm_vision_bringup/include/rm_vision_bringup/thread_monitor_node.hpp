@@ -0,0 +1,85 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__THREAD_MONITOR_NODE_HPP_
+#define RM_VISION_BRINGUP__THREAD_MONITOR_NODE_HPP_
+
+// ROS
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <std_srvs/srv/trigger.hpp>
+
+// STD
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/perf_counters.hpp"
+#include "rm_vision_bringup/proc_stat.hpp"
+
+namespace rm_vision_bringup
+{
+// Rates derived from two consecutive samples of the same thread
+struct ThreadUsage
+{
+  ThreadSample sample;
+  // Fraction of wall time spent running on a CPU
+  double busy_ratio = 0.0;
+  // Fraction of wall time spent runnable but waiting on a run queue
+  double wait_ratio = 0.0;
+  // Average run queue wait per scheduling slice
+  double wait_per_slice_us = 0.0;
+  double ctxt_switches_per_sec = 0.0;
+
+  // Hardware counters over the same period, only if perf_counters is enabled and permitted
+  bool has_counters = false;
+  double cycles_per_sec = 0.0;
+  double instructions_per_cycle = 0.0;
+  double cache_misses_per_sec = 0.0;
+  double branch_misses_per_sec = 0.0;
+};
+
+class ThreadMonitorNode : public rclcpp::Node
+{
+public:
+  explicit ThreadMonitorNode(const rclcpp::NodeOptions & options);
+
+private:
+  void sample();
+
+  void reportCallback(
+    const std_srvs::srv::Trigger::Request::SharedPtr request,
+    std_srvs::srv::Trigger::Response::SharedPtr response);
+
+  void sampleCounters(int tid, double dt, ThreadUsage & usage);
+
+  diagnostic_msgs::msg::DiagnosticStatus toStatus(const ThreadUsage & usage) const;
+
+  std::vector<std::string> processes_;
+  double busy_warn_ratio_;
+  bool perf_counters_;
+
+  struct ThreadCounters
+  {
+    std::unique_ptr<PerfCounterGroup> group;
+    PerfCounterGroup::Values last;
+    bool has_last = false;
+  };
+  std::map<int, ThreadCounters> counters_;
+
+  // Last raw sample of every thread, keyed by tid
+  std::map<int, ThreadSample> last_samples_;
+  rclcpp::Time last_sample_time_;
+
+  std::mutex usages_mutex_;
+  std::vector<ThreadUsage> usages_;
+
+  rclcpp::TimerBase::SharedPtr timer_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr threads_pub_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr report_srv_;
+};
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__THREAD_MONITOR_NODE_HPP_
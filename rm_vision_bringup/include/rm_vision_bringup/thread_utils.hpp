@@ -0,0 +1,16 @@
+// Copyright 2023 Chen Jun
+
+#ifndef RM_VISION_BRINGUP__THREAD_UTILS_HPP_
+#define RM_VISION_BRINGUP__THREAD_UTILS_HPP_
+
+namespace rm_vision_bringup
+{
+// Pins the calling thread to a single CPU, returns false on failure
+bool pinCurrentThread(int cpu);
+
+// Switches the calling thread to SCHED_FIFO, returns false on failure (e.g. missing CAP_SYS_NICE)
+bool setCurrentThreadFifo(int priority);
+
+}  // namespace rm_vision_bringup
+
+#endif  // RM_VISION_BRINGUP__THREAD_UTILS_HPP_
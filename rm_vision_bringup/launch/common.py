@@ -1,8 +1,10 @@
 import os
+import subprocess
 import yaml
 
-from ament_index_python.packages import get_package_share_directory
+from ament_index_python.packages import get_package_prefix, get_package_share_directory
 from launch.substitutions import Command
+from launch.actions import Shutdown
 from launch_ros.actions import Node
 
 launch_params = yaml.safe_load(open(os.path.join(
@@ -30,3 +32,116 @@ tracker_node = Node(
     parameters=[node_params],
     ros_arguments=['--log-level', 'armor_tracker:='+launch_params['tracker_log_level']],
 )
+
+serial_driver_node = Node(
+    package='rm_serial_driver',
+    executable='rm_serial_driver_node',
+    name='serial_driver',
+    output='both',
+    emulate_tty=True,
+    parameters=[node_params],
+    on_exit=Shutdown(),
+    ros_arguments=['--ros-args', '--log-level',
+                   'serial_driver:='+launch_params['serial_log_level']],
+)
+
+thread_monitor_node = Node(
+    package='rm_vision_bringup',
+    executable='thread_monitor_node',
+    name='thread_monitor',
+    output='both',
+    emulate_tty=True,
+    parameters=[node_params],
+)
+
+
+def get_thread_monitor_node(processes):
+    # For launches whose processes differ from the list in node_params
+    return Node(
+        package='rm_vision_bringup',
+        executable='thread_monitor_node',
+        name='thread_monitor',
+        output='both',
+        emulate_tty=True,
+        parameters=[node_params, {'processes': processes}],
+    )
+
+startup_profiler_node = Node(
+    package='rm_vision_bringup',
+    executable='startup_profiler_node',
+    name='startup_profiler',
+    output='both',
+    emulate_tty=True,
+    parameters=[node_params],
+)
+
+# Summarize with ros2 run rm_vision_bringup metrics_query.py ~/.ros/metrics.ring list
+metrics_recorder_node = Node(
+    package='rm_vision_bringup',
+    executable='metrics_recorder_node',
+    name='metrics_recorder',
+    output='both',
+    emulate_tty=True,
+    parameters=[node_params],
+)
+
+# Dump with ros2 service call /snapshot_recorder/dump std_srvs/srv/Trigger,
+# decode with ros2 run rm_vision_bringup snapshot_decode.py ~/.ros/snapshot_<stamp>.bin
+snapshot_recorder_node = Node(
+    package='rm_vision_bringup',
+    executable='snapshot_recorder_node',
+    name='snapshot_recorder',
+    output='both',
+    emulate_tty=True,
+    parameters=[node_params],
+)
+
+
+def get_detector_layout():
+    threads, cpus = launch_params['detector_threads'], launch_params['detector_cpus']
+    if not launch_params['auto_tune']:
+        return threads, cpus
+
+    # Calibrated once per machine, rerun on demand with `ros2 run rm_vision_bringup layout_tuner`
+    ros_home = os.environ.get('ROS_HOME') or os.path.join(os.path.expanduser('~'), '.ros')
+    tuning_file = os.path.join(ros_home, 'rm_vision_tuning.yaml')
+    tuning = None
+    if os.path.exists(tuning_file):
+        tuning = yaml.safe_load(open(tuning_file))
+    if not tuning or tuning.get('cpu_count') != len(os.sched_getaffinity(0)):
+        tuner = os.path.join(get_package_prefix('rm_vision_bringup'),
+                             'lib', 'rm_vision_bringup', 'layout_tuner')
+        if subprocess.run([tuner, tuning_file]).returncode != 0:
+            return threads, cpus
+        tuning = yaml.safe_load(open(tuning_file))
+    return tuning['detector_threads'], tuning['detector_cpus']
+
+
+def get_detector_process_args():
+    # OpenCV runs cvtColor/threshold/morphology as horizontal stripes on its worker pool,
+    # contours are still found on the whole binary image so blobs need no stitching
+    threads, cpus = get_detector_layout()
+    args = {'additional_env': {}}
+    if threads > 0:
+        args['additional_env']['OPENCV_FOR_THREADS_NUM'] = str(threads)
+    if cpus:
+        # Worker threads inherit the affinity of the process
+        args['prefix'] = 'taskset -c ' + cpus
+    return args
+
+
+def get_recorder_actions():
+    recorders = []
+    if launch_params['snapshot_recorder']:
+        recorders.append(snapshot_recorder_node)
+    if launch_params['metrics_recorder']:
+        recorders.append(metrics_recorder_node)
+    return recorders
+
+
+def get_trace_actions():
+    # Callback-to-thread mapping comes from ros2_tracing (callback_start/end carry the vtid)
+    if not launch_params['trace']:
+        return []
+    from tracetools_launch.action import Trace
+    return [Trace(session_name='rm_vision', append_timestamp=True, events_kernel=[])]
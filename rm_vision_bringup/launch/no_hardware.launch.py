@@ -6,7 +6,9 @@ sys.path.append(os.path.join(get_package_share_directory('rm_vision_bringup'), '
 
 def generate_launch_description():
 
-    from common import launch_params, robot_state_publisher, node_params, tracker_node
+    from common import launch_params, robot_state_publisher, node_params, tracker_node, \
+        thread_monitor_node, startup_profiler_node, get_detector_process_args, \
+        get_recorder_actions, get_trace_actions
     from launch_ros.actions import Node
     from launch import LaunchDescription
 
@@ -18,10 +20,13 @@ def generate_launch_description():
         parameters=[node_params],
         arguments=['--ros-args', '--log-level',
                    'armor_detector:='+launch_params['detector_log_level']],
+        **get_detector_process_args(),
     )
 
-    return LaunchDescription([
+    return LaunchDescription(get_trace_actions() + get_recorder_actions() + [
+        startup_profiler_node,
         robot_state_publisher,
+        thread_monitor_node,
         detector_node,
         tracker_node,
     ])
@@ -0,0 +1,66 @@
+import os
+import sys
+from ament_index_python.packages import get_package_share_directory
+sys.path.append(os.path.join(get_package_share_directory('rm_vision_bringup'), 'launch'))
+
+
+# Camera host of offloaded detection: camera, serial driver and the JPEG frame sender.
+# Start offload_detector.launch.py on the compute board in the same ROS_DOMAIN_ID, or on this
+# machine to test over loopback, and watch the stages with
+#   ros2 topic echo /frame_sender/stats
+#   ros2 topic echo /frame_receiver/latency
+def generate_launch_description():
+
+    from common import node_params, launch_params, robot_state_publisher, serial_driver_node, \
+        get_thread_monitor_node
+    from launch_ros.descriptions import ComposableNode
+    from launch_ros.actions import ComposableNodeContainer
+    from launch.actions import TimerAction, Shutdown
+    from launch import LaunchDescription
+
+    cameras = {
+        'hik': ('hik_camera', 'hik_camera::HikCameraNode'),
+        'mv': ('mindvision_camera', 'mindvision_camera::MVCameraNode'),
+    }
+    camera_package, camera_plugin = cameras[launch_params['camera']]
+
+    camera_sender_container = ComposableNodeContainer(
+        name='camera_sender_container',
+        namespace='',
+        package='rclcpp_components',
+        executable='component_container',
+        composable_node_descriptions=[
+            ComposableNode(
+                package=camera_package,
+                plugin=camera_plugin,
+                name='camera_node',
+                parameters=[node_params],
+                # Raw frames stay in this process, the detector host gets them from the sender
+                remappings=[('/image_raw', '/offload/image_raw'),
+                            ('/camera_info', '/offload/camera_info')],
+                extra_arguments=[{'use_intra_process_comms': True}]
+            ),
+            ComposableNode(
+                package='rm_vision_bringup',
+                plugin='rm_vision_bringup::FrameSenderNode',
+                name='frame_sender',
+                parameters=[node_params],
+                extra_arguments=[{'use_intra_process_comms': True}]
+            ),
+        ],
+        output='both',
+        emulate_tty=True,
+        on_exit=Shutdown(),
+    )
+
+    delay_serial_node = TimerAction(
+        period=1.5,
+        actions=[serial_driver_node],
+    )
+
+    return LaunchDescription([
+        robot_state_publisher,
+        get_thread_monitor_node(['camera_sender_container', 'rm_serial_driver_node']),
+        camera_sender_container,
+        delay_serial_node,
+    ])
@@ -0,0 +1,56 @@
+import os
+import sys
+from ament_index_python.packages import get_package_share_directory
+sys.path.append(os.path.join(get_package_share_directory('rm_vision_bringup'), 'launch'))
+
+
+# Detector host of offloaded detection: decodes the frames of offload_camera.launch.py
+# and runs the detector and tracker on them.
+def generate_launch_description():
+
+    from common import node_params, launch_params, tracker_node, get_thread_monitor_node, \
+        get_detector_process_args
+    from launch_ros.descriptions import ComposableNode
+    from launch_ros.actions import ComposableNodeContainer
+    from launch.actions import TimerAction, Shutdown
+    from launch import LaunchDescription
+
+    receiver_detector_container = ComposableNodeContainer(
+        name='receiver_detector_container',
+        namespace='',
+        package='rclcpp_components',
+        executable='component_container',
+        **get_detector_process_args(),
+        composable_node_descriptions=[
+            ComposableNode(
+                package='rm_vision_bringup',
+                plugin='rm_vision_bringup::FrameReceiverNode',
+                name='frame_receiver',
+                parameters=[node_params],
+                extra_arguments=[{'use_intra_process_comms': True}]
+            ),
+            ComposableNode(
+                package='armor_detector',
+                plugin='rm_auto_aim::ArmorDetectorNode',
+                name='armor_detector',
+                parameters=[node_params],
+                extra_arguments=[{'use_intra_process_comms': True}]
+            ),
+        ],
+        output='both',
+        emulate_tty=True,
+        ros_arguments=['--ros-args', '--log-level',
+                       'armor_detector:='+launch_params['detector_log_level']],
+        on_exit=Shutdown(),
+    )
+
+    delay_tracker_node = TimerAction(
+        period=2.0,
+        actions=[tracker_node],
+    )
+
+    return LaunchDescription([
+        get_thread_monitor_node(['receiver_detector_container', 'armor_tracker_node']),
+        receiver_detector_container,
+        delay_tracker_node,
+    ])
@@ -6,9 +6,11 @@ sys.path.append(os.path.join(get_package_share_directory('rm_vision_bringup'), '
 
 def generate_launch_description():
 
-    from common import node_params, launch_params, robot_state_publisher, tracker_node
+    from common import node_params, launch_params, robot_state_publisher, tracker_node, \
+        serial_driver_node, thread_monitor_node, startup_profiler_node, \
+        get_detector_process_args, get_recorder_actions, get_trace_actions
     from launch_ros.descriptions import ComposableNode
-    from launch_ros.actions import ComposableNodeContainer, Node
+    from launch_ros.actions import ComposableNodeContainer, LoadComposableNodes, Node
     from launch.actions import TimerAction, Shutdown
     from launch import LaunchDescription
 
@@ -21,26 +23,73 @@ def generate_launch_description():
             extra_arguments=[{'use_intra_process_comms': True}]
         )
 
-    def get_camera_detector_container(camera_node):
+    def get_camera_detector_container(camera_package, camera_node):
+        container = get_detector_process_args()
+        priority_executor = launch_params['priority_executor']
+        if launch_params['eager_plugin_loading'] or launch_params['busy_poll']['enable'] or \
+                priority_executor['enable']:
+            container.update({
+                'package': 'rm_vision_bringup',
+                'executable': 'rm_vision_container',
+                'parameters': [{
+                    'busy_poll': launch_params['busy_poll']['enable'],
+                    'busy_poll_cpu': launch_params['busy_poll']['cpu'],
+                    'busy_poll_spin_window_us': launch_params['busy_poll']['spin_window_us'],
+                    'priority_executor': priority_executor['enable'],
+                    'priority_executor_rt_priority': priority_executor['rt_priority'],
+                    'priority_executor_report_period': priority_executor['report_period'],
+                    'node_priorities': ['%s:%d:%f' % (name, p['priority'], p['deadline_ms'])
+                                        for name, p in priority_executor['nodes'].items()],
+                }],
+            })
+            if launch_params['eager_plugin_loading']:
+                # dlopen the plugins at container start and bind all symbols immediately
+                container['parameters'].append(
+                    {'preload_packages': [camera_package, 'armor_detector']})
+                container['additional_env']['LD_BIND_NOW'] = '1'
+        else:
+            container.update({
+                'package': 'rclcpp_components',
+                'executable': 'component_container',
+            })
+
+        composable_nodes = [
+            camera_node,
+            ComposableNode(
+                package='armor_detector',
+                plugin='rm_auto_aim::ArmorDetectorNode',
+                name='armor_detector',
+                parameters=[node_params],
+                extra_arguments=[{'use_intra_process_comms': True}]
+            )
+        ]
+        # Idle until /detector_profiler/start is called, also covers the tracker if composed
+        composable_nodes.append(ComposableNode(
+            package='rm_vision_bringup',
+            plugin='rm_vision_bringup::SamplingProfilerNode',
+            name='detector_profiler',
+            parameters=[node_params],
+        ))
+        if launch_params['latency_probe']:
+            # Runs in the container so it shares the process affinity of the hot path
+            composable_nodes.append(ComposableNode(
+                package='rm_vision_bringup',
+                plugin='rm_vision_bringup::LatencyProbeNode',
+                name='latency_probe',
+                parameters=[node_params],
+            ))
+
         return ComposableNodeContainer(
             name='camera_detector_container',
             namespace='',
-            package='rclcpp_components',
-            executable='component_container',
-            composable_node_descriptions=[
-                camera_node,
-                ComposableNode(
-                    package='armor_detector',
-                    plugin='rm_auto_aim::ArmorDetectorNode',
-                    name='armor_detector',
-                    parameters=[node_params],
-                    extra_arguments=[{'use_intra_process_comms': True}]
-                )
-            ],
+            **container,
+            composable_node_descriptions=composable_nodes,
             output='both',
             emulate_tty=True,
             ros_arguments=['--ros-args', '--log-level',
-                           'armor_detector:='+launch_params['detector_log_level']],
+                           'armor_detector:='+launch_params['detector_log_level'],
+                           '--log-level',
+                           'armor_tracker:='+launch_params['tracker_log_level']],
             on_exit=Shutdown(),
         )
 
@@ -48,20 +97,19 @@ def generate_launch_description():
     mv_camera_node = get_camera_node('mindvision_camera', 'mindvision_camera::MVCameraNode')
 
     if (launch_params['camera'] == 'hik'):
-        cam_detector = get_camera_detector_container(hik_camera_node)
+        cam_detector = get_camera_detector_container('hik_camera', hik_camera_node)
     elif (launch_params['camera'] == 'mv'):
-        cam_detector = get_camera_detector_container(mv_camera_node)
+        cam_detector = get_camera_detector_container('mindvision_camera', mv_camera_node)
 
-    serial_driver_node = Node(
-        package='rm_serial_driver',
-        executable='rm_serial_driver_node',
-        name='serial_driver',
+    # Always-on capture of the raw bytes exchanged with the MCU, decode with
+    # ros2 run rm_vision_bringup serial_capture_decode.py ~/.ros/serial_capture.ring
+    serial_capture_node = Node(
+        package='rm_vision_bringup',
+        executable='serial_capture_node',
+        name='serial_capture',
         output='both',
         emulate_tty=True,
         parameters=[node_params],
-        on_exit=Shutdown(),
-        ros_arguments=['--ros-args', '--log-level',
-                       'serial_driver:='+launch_params['serial_log_level']],
     )
 
     delay_serial_node = TimerAction(
@@ -69,14 +117,34 @@ def generate_launch_description():
         actions=[serial_driver_node],
     )
 
+    if launch_params['compose_tracker']:
+        # Armors are handed over intra-process instead of being serialized to another process
+        tracker = LoadComposableNodes(
+            target_container='camera_detector_container',
+            composable_node_descriptions=[
+                ComposableNode(
+                    package='armor_tracker',
+                    plugin='rm_auto_aim::ArmorTrackerNode',
+                    name='armor_tracker',
+                    parameters=[node_params],
+                    extra_arguments=[{'use_intra_process_comms': True}]
+                )
+            ],
+        )
+    else:
+        tracker = tracker_node
+
     delay_tracker_node = TimerAction(
         period=2.0,
-        actions=[tracker_node],
+        actions=[tracker],
     )
 
-    return LaunchDescription([
+    return LaunchDescription(get_trace_actions() + get_recorder_actions() + [
+        startup_profiler_node,
         robot_state_publisher,
+        thread_monitor_node,
         cam_detector,
+        serial_capture_node,
         delay_serial_node,
         delay_tracker_node,
     ])
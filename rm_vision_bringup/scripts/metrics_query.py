@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Summarize the pipeline metrics recorded by metrics_recorder.
+
+Frame ages are aggregated per period of the recorder: the mean rows show the median period,
+the max rows the maximum of all periods. The recorder keeps no per-frame ages, so there is no
+session-wide p99; the p99 rows show the median and the worst of the per-period p99s.
+
+The history is split into sessions (usually one per match) wherever no record was written
+for --gap seconds, i.e. while the robot was powered off.
+
+  metrics_query.py ~/.ros/metrics.ring list
+  metrics_query.py ~/.ros/metrics.ring summary -1        # latest session
+  metrics_query.py ~/.ros/metrics.ring summary -2 -1     # compare the last two sessions
+"""
+
+import argparse
+import math
+import struct
+import time
+
+from serial_capture_decode import read_records
+
+# Same layout as MetricsRecord in metrics_recorder_node.hpp
+RECORD = struct.Struct('<4f3I7f')
+FIELDS = ('detector_age_mean_ms', 'detector_age_max_ms', 'tracker_age_mean_ms',
+          'tracker_age_max_ms', 'frames', 'detections', 'armors', 'tracking_ratio',
+          'position_diff_mean', 'yaw_diff_mean', 'cpu_busy_ratio', 'max_temperature',
+          'cpu_frequency_mhz', 'detector_age_p99_ms')
+# Records written before detector_age_p99_ms was added
+RECORD_V1 = struct.Struct('<4f3I6f')
+
+
+def load_sessions(path, gap):
+    sessions = []
+    last_stamp = None
+    for stamp_ns, _, payload in read_records(path):
+        if len(payload) >= RECORD.size:
+            values = RECORD.unpack_from(payload)
+        elif len(payload) >= RECORD_V1.size:
+            values = RECORD_V1.unpack_from(payload) + (math.nan,)
+        else:
+            continue
+        record = dict(zip(FIELDS, values))
+        record['stamp'] = stamp_ns / 1e9
+        if last_stamp is None or record['stamp'] - last_stamp > gap:
+            sessions.append([])
+        sessions[-1].append(record)
+        last_stamp = record['stamp']
+    return sessions
+
+
+def percentile(values, fraction):
+    values = sorted(v for v in values if not math.isnan(v))
+    if not values:
+        return math.nan
+    return values[min(len(values) - 1, int(fraction * len(values)))]
+
+
+def summarize(records):
+    frames = sum(r['frames'] for r in records)
+    detections = sum(r['detections'] for r in records)
+    active = [r for r in records if r['detections'] > 0]
+    tracked = [r for r in records if r['tracking_ratio'] > 0]
+    duration = records[-1]['stamp'] - records[0]['stamp'] + 1
+
+    def column(name, rows=records):
+        return [r[name] for r in rows]
+
+    return [
+        ('start', time.strftime('%m-%d %H:%M:%S', time.localtime(records[0]['stamp']))),
+        ('duration s', duration),
+        ('camera fps', frames / duration),
+        ('dropped %', 100.0 * (frames - detections) / frames if frames else math.nan),
+        ('detector age mean ms', percentile(column('detector_age_mean_ms', active), 0.5)),
+        ('detector p99 median ms', percentile(column('detector_age_p99_ms', active), 0.5)),
+        ('detector p99 worst ms', percentile(column('detector_age_p99_ms', active), 1.0)),
+        ('detector age max ms', max(column('detector_age_max_ms'), default=math.nan)),
+        ('tracker age mean ms', percentile(column('tracker_age_mean_ms', active), 0.5)),
+        ('tracker age max ms', max(column('tracker_age_max_ms'), default=math.nan)),
+        ('tracking %', 100.0 * len(tracked) / len(records)),
+        ('position diff p50', percentile(column('position_diff_mean', tracked), 0.5)),
+        ('yaw diff p50', percentile(column('yaw_diff_mean', tracked), 0.5)),
+        ('cpu busy p50 %', 100.0 * percentile(column('cpu_busy_ratio'), 0.5)),
+        ('cpu busy max %', 100.0 * max(column('cpu_busy_ratio'))),
+        ('temperature max C', percentile(column('max_temperature'), 1.0)),
+        ('cpu freq min MHz', percentile(column('cpu_frequency_mhz'), 0.0)),
+    ]
+
+
+def format_value(value):
+    return value if isinstance(value, str) else '%.3f' % value
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('ring', help='metrics file, e.g. ~/.ros/metrics.ring')
+    parser.add_argument('command', choices=['list', 'summary'])
+    parser.add_argument('sessions', type=int, nargs='*', default=[-1],
+                        help='session indices as shown by list, negative counts from the end')
+    parser.add_argument('--gap', type=float, default=60.0,
+                        help='seconds without records that start a new session')
+    args = parser.parse_args()
+
+    sessions = load_sessions(args.ring, args.gap)
+    if args.command == 'list':
+        if not sessions:
+            print('no records in %s' % args.ring)
+        for i, records in enumerate(sessions):
+            summary = dict(summarize(records))
+            print('%3d  %s  %7.0f s  %5.1f fps  tracking %5.1f %%' % (
+                i, summary['start'], summary['duration s'], summary['camera fps'],
+                summary['tracking %']))
+        return
+
+    invalid = [i for i in args.sessions if not -len(sessions) <= i < len(sessions)]
+    if invalid:
+        parser.error('no session %s, %s has %d' % (
+            ', '.join(map(str, invalid)), args.ring, len(sessions)))
+    summaries = [summarize(sessions[i]) for i in args.sessions]
+    print('%-22s' % 'session' + ''.join('%16d' % i for i in args.sessions))
+    for row, (name, _) in enumerate(summaries[0]):
+        print('%-22s' % name +
+              ''.join('%16s' % format_value(summary[row][1]) for summary in summaries))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Decode the serial capture ring written by serial_capture_node.
+
+Prints one line per USB transfer with its CLOCK_REALTIME timestamp, so it can be
+lined up with ROS message stamps and traces of the pipeline.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'RMSCAP1\x00'
+SYNC = 0x5AA5
+RING_HEADER = struct.Struct('<8sQQQ32x')
+RECORD_HEADER = struct.Struct('<HBBIq')
+DIRECTIONS = {0: 'TX', 1: 'RX'}
+
+
+def walk_records(read, start, write_pos):
+    """Yield (stamp_ns, direction, payload) of the records between start and write_pos.
+
+    read(pos, size) returns the ring bytes at absolute position pos. If start is not 0 it may
+    fall inside a record overwritten by the writer, so decoding resyncs on the next header.
+    """
+    pos = start
+    synced = pos == 0
+    while pos + RECORD_HEADER.size <= write_pos:
+        sync, direction, _, length, stamp_ns = RECORD_HEADER.unpack(read(pos, RECORD_HEADER.size))
+        end = pos + RECORD_HEADER.size + length
+        valid = sync == SYNC and direction in DIRECTIONS and end <= write_pos
+        if not valid:
+            if synced:
+                sys.exit('Corrupted record at byte %d' % pos)
+            pos += 8
+            continue
+        synced = True
+        yield stamp_ns, direction, read(pos + RECORD_HEADER.size, length)
+        pos = (end + 7) & ~7
+
+
+def read_records(path):
+    with open(path, 'rb') as f:
+        raw = f.read()
+    magic, capacity, write_pos, claim_pos = RING_HEADER.unpack_from(raw)
+    if magic != MAGIC:
+        sys.exit('%s is not a serial capture ring' % path)
+    data = raw[RING_HEADER.size:RING_HEADER.size + capacity]
+
+    def read(pos, size):
+        offset = pos % capacity
+        chunk = data[offset:offset + size]
+        return chunk + data[:size - len(chunk)]
+
+    # A record the writer was writing when it stopped may have overwritten the oldest bytes
+    return walk_records(read, max(0, max(write_pos, claim_pos) - capacity), write_pos)
+
+
+def format_record(stamp_ns, direction, payload, csv=False):
+    if csv:
+        return '%.6f,%s,%d,%s' % (stamp_ns / 1e9, DIRECTIONS[direction], len(payload),
+                                  payload.hex())
+    return '%.6f %s %4d  %s' % (stamp_ns / 1e9, DIRECTIONS[direction], len(payload),
+                                payload.hex(' '))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('ring', help='capture file, e.g. ~/.ros/serial_capture.ring')
+    parser.add_argument('--since', type=float, help='first timestamp to print (epoch seconds)')
+    parser.add_argument('--until', type=float, help='last timestamp to print (epoch seconds)')
+    parser.add_argument('--csv', action='store_true', help='print stamp,direction,length,hex')
+    args = parser.parse_args()
+
+    for stamp_ns, direction, payload in read_records(args.ring):
+        stamp = stamp_ns / 1e9
+        if (args.since and stamp < args.since) or (args.until and stamp > args.until):
+            continue
+        print(format_record(stamp_ns, direction, payload, args.csv))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Decode a pipeline snapshot written by snapshot_recorder (~/dump service).
+
+Prints the recorded messages of every topic (oldest first), the parameter values of every
+node and the serial bytes exchanged with the MCU, all with CLOCK_REALTIME timestamps.
+Messages are deserialized if the workspace that defines their types is sourced.
+"""
+
+import argparse
+import struct
+import sys
+
+from serial_capture_decode import format_record, walk_records
+
+MAGIC = b'RMSNAP1\x00'
+TOPIC_SECTION = 1
+PARAMETER_SECTION = 2
+SERIAL_SECTION = 3
+
+
+class Reader:
+
+    def __init__(self, raw):
+        self.raw = raw
+        self.pos = 0
+
+    def done(self):
+        return self.pos >= len(self.raw)
+
+    def unpack(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.raw, self.pos)
+        self.pos += struct.calcsize('<' + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def bytes(self, size):
+        data = self.raw[self.pos:self.pos + size]
+        self.pos += size
+        return data
+
+    def string(self):
+        return self.bytes(self.unpack('H')).decode()
+
+
+def message_formatter(msg_type):
+    try:
+        from rclpy.serialization import deserialize_message
+        from rosidl_runtime_py import message_to_yaml
+        from rosidl_runtime_py.utilities import get_message
+        msg_class = get_message(msg_type)
+    except (ImportError, AttributeError, ModuleNotFoundError, ValueError):
+        return lambda data: '<%d bytes, %s not available>' % (len(data), msg_type)
+    return lambda data: message_to_yaml(deserialize_message(data, msg_class))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('snapshot', help='file written by ~/dump, e.g. ~/.ros/snapshot_*.bin')
+    parser.add_argument('--topic', action='append', help='only print these topics')
+    parser.add_argument('--last', type=int, help='only print the newest N messages per topic')
+    args = parser.parse_args()
+
+    with open(args.snapshot, 'rb') as f:
+        reader = Reader(f.read())
+    if reader.bytes(8) != MAGIC:
+        sys.exit('%s is not a pipeline snapshot' % args.snapshot)
+    print('Snapshot taken at %.6f' % (reader.unpack('q') / 1e9))
+
+    while not reader.done():
+        section = reader.unpack('B')
+        if section == TOPIC_SECTION:
+            topic = reader.string()
+            msg_type = reader.string()
+            messages = [(reader.unpack('q'), reader.bytes(reader.unpack('I')))
+                        for _ in range(reader.unpack('I'))]
+            if args.topic and topic not in args.topic:
+                continue
+            if args.last:
+                messages = messages[-args.last:]
+            print('\n=== %s [%s] %d messages' % (topic, msg_type, len(messages)))
+            formatter = message_formatter(msg_type)
+            for stamp_ns, data in messages:
+                print('--- received %.6f' % (stamp_ns / 1e9))
+                print(formatter(data).rstrip())
+        elif section == PARAMETER_SECTION:
+            node = reader.string()
+            parameters = [(reader.string(), reader.string()) for _ in range(reader.unpack('I'))]
+            if args.topic:
+                continue
+            print('\n=== parameters of %s' % node)
+            for name, value in parameters:
+                print('%s: %s' % (name, value))
+        elif section == SERIAL_SECTION:
+            start = reader.unpack('Q')
+            data = reader.bytes(reader.unpack('I'))
+            if args.topic:
+                continue
+            print('\n=== serial capture')
+            for record in walk_records(lambda pos, size: data[pos - start:pos - start + size],
+                                       start, start + len(data)):
+                print(format_record(*record))
+        else:
+            sys.exit('Unknown section %d at byte %d' % (section, reader.pos - 1))
+
+
+if __name__ == '__main__':
+    main()
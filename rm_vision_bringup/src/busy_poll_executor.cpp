@@ -0,0 +1,41 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/busy_poll_executor.hpp"
+
+#include <rcpputils/scope_exit.hpp>
+
+// STD
+#include <chrono>
+#include <stdexcept>
+
+namespace rm_vision_bringup
+{
+BusyPollExecutor::BusyPollExecutor(
+  std::chrono::nanoseconds spin_window, const rclcpp::ExecutorOptions & options)
+: SingleThreadedExecutor(options), spin_window_(spin_window)
+{
+}
+
+void BusyPollExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false););
+
+  // Blocks until the first callback, polling only starts after work
+  auto window_end = std::chrono::steady_clock::now();
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    bool in_window = std::chrono::steady_clock::now() < window_end;
+    // Zero timeout polls, negative timeout blocks until work arrives
+    auto timeout = in_window ? std::chrono::nanoseconds(0) : std::chrono::nanoseconds(-1);
+
+    rclcpp::AnyExecutable any_executable;
+    if (get_next_executable(any_executable, timeout)) {
+      execute_any_executable(any_executable);
+      window_end = std::chrono::steady_clock::now() + spin_window_;
+    }
+  }
+}
+
+}  // namespace rm_vision_bringup
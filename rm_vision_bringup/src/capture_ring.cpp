@@ -0,0 +1,151 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/capture_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// STD
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+constexpr char CaptureRing::kMagic[8];
+
+CaptureRing::~CaptureRing()
+{
+  if (header_ != nullptr) {
+    munmap(header_, mapped_size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool CaptureRing::open(const std::string & path, size_t capacity)
+{
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    return false;
+  }
+
+  mapped_size_ = sizeof(RingHeader) + capacity;
+  struct stat st;
+  bool reuse = fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) == mapped_size_;
+  if (!reuse && ftruncate(fd_, mapped_size_) != 0) {
+    return false;
+  }
+
+  void * addr = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  header_ = static_cast<RingHeader *>(addr);
+  data_ = static_cast<uint8_t *>(addr) + sizeof(RingHeader);
+
+  if (
+    !reuse || std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 ||
+    header_->capacity != capacity) {
+    std::memset(addr, 0, mapped_size_);
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+    header_->capacity = capacity;
+    header_->write_pos.store(0);
+  }
+  return true;
+}
+
+void CaptureRing::append(
+  uint8_t direction, int64_t stamp_ns, const uint8_t * data, uint32_t length)
+{
+  if (header_ == nullptr) {
+    return;
+  }
+
+  RecordHeader record{kSync, direction, 0, length, stamp_ns};
+  uint64_t pos = header_->write_pos.load(std::memory_order_relaxed);
+  uint64_t size = (sizeof(record) + length + 7) & ~uint64_t{7};
+
+  // Once the ring has wrapped, the record overwrites the oldest published bytes. Claim them
+  // before touching them so readers drop that range, also if we crash halfway through.
+  uint64_t claim = header_->claim_pos.load(std::memory_order_relaxed);
+  header_->claim_pos.store(std::max(claim, pos + size), std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  write(pos, &record, sizeof(record));
+  write(pos + sizeof(record), data, length);
+
+  // The record itself becomes visible only after its bytes are in place
+  header_->write_pos.store(pos + size, std::memory_order_release);
+}
+
+bool CaptureRing::readTail(
+  const std::string & path, size_t max_bytes, uint64_t & start, std::vector<uint8_t> & bytes)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  void * addr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > sizeof(RingHeader)) {
+    addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+
+  const auto * header = static_cast<const RingHeader *>(addr);
+  const auto * data = static_cast<const uint8_t *>(addr) + sizeof(RingHeader);
+  const uint64_t capacity = header->capacity;
+  bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+    sizeof(RingHeader) + capacity == static_cast<size_t>(st.st_size);
+
+  if (valid) {
+    uint64_t end = header->write_pos.load(std::memory_order_acquire);
+    start = end - std::min<uint64_t>(end, std::min<uint64_t>(capacity, max_bytes));
+    // Records are 8-byte aligned, so is the position a reader resyncs from
+    start = (start + 7) & ~uint64_t{7};
+    bytes.resize(end - start);
+    for (uint64_t pos = start; pos < end; ) {
+      size_t offset = pos % capacity;
+      size_t chunk = std::min<uint64_t>(end - pos, capacity - offset);
+      std::memcpy(bytes.data() + (pos - start), data + offset, chunk);
+      pos += chunk;
+    }
+
+    // The writer keeps going, drop what it may have overwritten before or while we were
+    // copying, including the record it is writing right now
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claimed = std::max(end, header->claim_pos.load(std::memory_order_relaxed));
+    if (claimed > start + capacity) {
+      uint64_t overwritten =
+        std::min<uint64_t>((claimed - capacity - start + 7) & ~uint64_t{7}, bytes.size());
+      bytes.erase(bytes.begin(), bytes.begin() + overwritten);
+      start += overwritten;
+    }
+  }
+  munmap(addr, st.st_size);
+  return valid;
+}
+
+void CaptureRing::write(uint64_t pos, const void * src, size_t size)
+{
+  const auto * bytes = static_cast<const uint8_t *>(src);
+  const uint64_t capacity = header_->capacity;
+  while (size > 0) {
+    size_t offset = pos % capacity;
+    size_t chunk = std::min<size_t>(size, capacity - offset);
+    std::memcpy(data_ + offset, bytes, chunk);
+    pos += chunk;
+    bytes += chunk;
+    size -= chunk;
+  }
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,100 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/frame_receiver_node.hpp"
+
+// OpenCV
+#include <opencv2/imgcodecs.hpp>
+
+// STD
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace rm_vision_bringup
+{
+FrameReceiverNode::FrameReceiverNode(const rclcpp::NodeOptions & options)
+: Node("frame_receiver", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting FrameReceiverNode!");
+
+  max_age_ms_ = this->declare_parameter("max_age_ms", 30.0);
+
+  image_pub_ =
+    this->create_publisher<sensor_msgs::msg::Image>("/image_raw", rclcpp::SensorDataQoS());
+  stats_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "~/latency", rclcpp::SystemDefaultsQoS());
+
+  compressed_sub_ = this->create_subscription<sensor_msgs::msg::CompressedImage>(
+    "/offload/compressed", rclcpp::SensorDataQoS().keep_last(1),
+    std::bind(&FrameReceiverNode::compressedCallback, this, std::placeholders::_1));
+
+  stats_timer_ = this->create_wall_timer(
+    std::chrono::seconds(1), std::bind(&FrameReceiverNode::publishStats, this));
+}
+
+void FrameReceiverNode::compressedCallback(
+  const sensor_msgs::msg::CompressedImage::ConstSharedPtr msg)
+{
+  auto age_ms = [this, &msg]() {
+      return (this->now() - rclcpp::Time(msg->header.stamp)).seconds() * 1e3;
+    };
+
+  double arrival_age_ms = age_ms();
+  if (arrival_age_ms > max_age_ms_) {
+    stale_frames_++;
+    return;
+  }
+  arrival_age_ms_.add(arrival_age_ms);
+
+  auto start = std::chrono::steady_clock::now();
+  cv::Mat frame = cv::imdecode(msg->data, cv::IMREAD_UNCHANGED);
+  if (frame.empty()) {
+    RCLCPP_WARN_THROTTLE(this->get_logger(), *this->get_clock(), 1000, "Failed to decode frame");
+    return;
+  }
+
+  auto image = std::make_unique<sensor_msgs::msg::Image>();
+  image->header = msg->header;
+  image->encoding = msg->format.substr(0, msg->format.find(';'));
+  image->height = frame.rows;
+  image->width = frame.cols;
+  image->step = frame.cols * frame.elemSize();
+  image->data.assign(frame.datastart, frame.dataend);
+  decode_ms_.add(
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+  ready_age_ms_.add(age_ms());
+  image_pub_->publish(std::move(image));
+}
+
+void FrameReceiverNode::publishStats()
+{
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = "frame_receiver";
+  status.hardware_id = "rm_vision";
+  status.level = stale_frames_ > 0 ? diagnostic_msgs::msg::DiagnosticStatus::WARN :
+                                     diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.message = std::to_string(ready_age_ms_.count) + " frames, " +
+    std::to_string(stale_frames_) + " stale";
+  stale_frames_ = 0;
+  // Capture to arrival on this host, decoding, capture to handing over to the detector
+  arrival_age_ms_.report(status, "arrival_age_ms");
+  decode_ms_.report(status, "decode_ms");
+  ready_age_ms_.report(status, "ready_age_ms");
+
+  diagnostic_msgs::msg::DiagnosticArray array;
+  array.header.stamp = this->now();
+  array.status.push_back(status);
+  stats_pub_->publish(array);
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::FrameReceiverNode)
@@ -0,0 +1,138 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/frame_sender_node.hpp"
+
+// OpenCV
+#include <opencv2/imgcodecs.hpp>
+
+// ROS
+#include <sensor_msgs/image_encodings.hpp>
+
+// STD
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+FrameSenderNode::FrameSenderNode(const rclcpp::NodeOptions & options)
+: Node("frame_sender", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting FrameSenderNode!");
+
+  int jpeg_quality = this->declare_parameter("jpeg_quality", 90);
+  encode_params_ = {cv::IMWRITE_JPEG_QUALITY, jpeg_quality};
+  auto roi = this->declare_parameter("roi", std::vector<int64_t>{0, 0, 0, 0});
+  if (roi.size() != 4 || roi[0] < 0 || roi[1] < 0 || roi[2] < 0 || roi[3] < 0) {
+    RCLCPP_ERROR(this->get_logger(), "roi must be [x, y, width, height] >= 0, ignoring it");
+  } else {
+    roi_ = cv::Rect(roi[0], roi[1], roi[2], roi[3]);
+  }
+
+  // Keep only the newest frame on the link, a late frame is worth nothing to the tracker
+  auto qos = rclcpp::SensorDataQoS().keep_last(1);
+  compressed_pub_ =
+    this->create_publisher<sensor_msgs::msg::CompressedImage>("/offload/compressed", qos);
+  camera_info_pub_ = this->create_publisher<sensor_msgs::msg::CameraInfo>(
+    "/camera_info", rclcpp::SensorDataQoS());
+  stats_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "~/stats", rclcpp::SystemDefaultsQoS());
+
+  image_sub_ = this->create_subscription<sensor_msgs::msg::Image>(
+    "/offload/image_raw", qos,
+    std::bind(&FrameSenderNode::imageCallback, this, std::placeholders::_1));
+  camera_info_sub_ = this->create_subscription<sensor_msgs::msg::CameraInfo>(
+    "/offload/camera_info", rclcpp::SensorDataQoS(),
+    std::bind(&FrameSenderNode::cameraInfoCallback, this, std::placeholders::_1));
+
+  stats_timer_ = this->create_wall_timer(
+    std::chrono::seconds(1), std::bind(&FrameSenderNode::publishStats, this));
+}
+
+void FrameSenderNode::imageCallback(const sensor_msgs::msg::Image::ConstSharedPtr msg)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  namespace enc = sensor_msgs::image_encodings;
+  int channels = enc::numChannels(msg->encoding);
+  if (enc::bitDepth(msg->encoding) != 8 || (channels != 1 && channels != 3)) {
+    RCLCPP_WARN_ONCE(this->get_logger(), "Cannot send %s frames as JPEG", msg->encoding.c_str());
+    return;
+  }
+
+  // Encoded as if it were BGR, the receiver gets the same channel order back
+  cv::Mat frame(
+    msg->height, msg->width, CV_8UC(channels), const_cast<uint8_t *>(msg->data.data()),
+    msg->step);
+  if (roi_.area() > 0) {
+    // Frames smaller than configured get the part of the ROI inside them
+    cv::Rect roi = roi_ & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (roi.area() == 0) {
+      RCLCPP_ERROR_THROTTLE(
+        this->get_logger(), *this->get_clock(), 5000, "roi is outside the %dx%d frame",
+        frame.cols, frame.rows);
+      return;
+    }
+    frame = frame(roi);
+  }
+  if (frame.empty()) {
+    return;
+  }
+
+  auto compressed = std::make_unique<sensor_msgs::msg::CompressedImage>();
+  compressed->header = msg->header;
+  compressed->format = msg->encoding + "; jpeg";
+  cv::imencode(".jpg", frame, compressed->data, encode_params_);
+
+  encode_ms_.add(
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  frame_kb_.add(compressed->data.size() / 1024.0);
+  compressed_pub_->publish(std::move(compressed));
+}
+
+void FrameSenderNode::cameraInfoCallback(const sensor_msgs::msg::CameraInfo::ConstSharedPtr msg)
+{
+  auto camera_info = std::make_unique<sensor_msgs::msg::CameraInfo>(*msg);
+  if (roi_.area() > 0) {
+    cv::Rect roi = roi_ & cv::Rect(0, 0, msg->width, msg->height);
+    if (roi.area() == 0) {
+      // No frames are sent either
+      return;
+    }
+    camera_info->width = roi.width;
+    camera_info->height = roi.height;
+    camera_info->k[2] -= roi.x;
+    camera_info->k[5] -= roi.y;
+    camera_info->p[2] -= roi.x;
+    camera_info->p[6] -= roi.y;
+  }
+  camera_info_pub_->publish(std::move(camera_info));
+}
+
+void FrameSenderNode::publishStats()
+{
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = "frame_sender";
+  status.hardware_id = "rm_vision";
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.message = std::to_string(encode_ms_.count) + " frames";
+  encode_ms_.report(status, "encode_ms");
+  frame_kb_.report(status, "frame_kb");
+
+  diagnostic_msgs::msg::DiagnosticArray array;
+  array.header.stamp = this->now();
+  array.status.push_back(status);
+  stats_pub_->publish(array);
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::FrameSenderNode)
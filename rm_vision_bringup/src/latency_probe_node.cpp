@@ -0,0 +1,168 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/latency_probe_node.hpp"
+
+#include <time.h>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/thread_utils.hpp"
+
+namespace rm_vision_bringup
+{
+LatencyProbeNode::LatencyProbeNode(const rclcpp::NodeOptions & options)
+: Node("latency_probe", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting LatencyProbeNode!");
+
+  interval_us_ = this->declare_parameter("interval_us", 1000);
+  cpu_ = this->declare_parameter("cpu", -1);
+  priority_ = this->declare_parameter("priority", 0);
+  bin_width_us_ = this->declare_parameter("bin_width_us", 5);
+  int bin_count = this->declare_parameter("bin_count", 200);
+  double publish_rate = this->declare_parameter("publish_rate", 1.0);
+
+  if (interval_us_ <= 0 || bin_width_us_ <= 0 || bin_count <= 0 || publish_rate <= 0.0) {
+    RCLCPP_ERROR(
+      this->get_logger(),
+      "interval_us, bin_width_us, bin_count and publish_rate must be positive, probe disabled");
+    return;
+  }
+
+  // The last bin also counts everything beyond the histogram range
+  bins_ = std::vector<std::atomic<uint64_t>>(bin_count);
+
+  histogram_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "~/histogram", rclcpp::SystemDefaultsQoS());
+  publish_timer_ = this->create_wall_timer(
+    std::chrono::duration<double>(1.0 / publish_rate),
+    std::bind(&LatencyProbeNode::publishHistogram, this));
+
+  probe_thread_ = std::thread(&LatencyProbeNode::probeLoop, this);
+}
+
+LatencyProbeNode::~LatencyProbeNode()
+{
+  running_ = false;
+  if (probe_thread_.joinable()) {
+    probe_thread_.join();
+  }
+}
+
+void LatencyProbeNode::probeLoop()
+{
+  if (cpu_ >= 0 && !pinCurrentThread(cpu_)) {
+    RCLCPP_ERROR(this->get_logger(), "Failed to pin probe thread to CPU %d", cpu_);
+  }
+  if (priority_ > 0 && !setCurrentThreadFifo(priority_)) {
+    RCLCPP_ERROR(this->get_logger(), "Failed to set SCHED_FIFO priority %d", priority_);
+  }
+
+  const int64_t interval_ns = static_cast<int64_t>(interval_us_) * 1000;
+  const int64_t bin_width_ns = static_cast<int64_t>(bin_width_us_) * 1000;
+  const int64_t last_bin = static_cast<int64_t>(bins_.size()) - 1;
+
+  auto advance = [](timespec & t, int64_t ns) {
+    ns += t.tv_nsec;
+    t.tv_sec += ns / 1000000000;
+    t.tv_nsec = ns % 1000000000;
+  };
+
+  timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (running_) {
+    advance(next, interval_ns);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    // Clamped in case the sleep was interrupted by a signal
+    int64_t latency_ns = std::max<int64_t>(
+      0, (now.tv_sec - next.tv_sec) * 1000000000LL + (now.tv_nsec - next.tv_nsec));
+
+    bins_[std::min(latency_ns / bin_width_ns, last_bin)].fetch_add(1, std::memory_order_relaxed);
+    int64_t max = max_latency_ns_.load(std::memory_order_relaxed);
+    while (latency_ns > max &&
+           !max_latency_ns_.compare_exchange_weak(max, latency_ns, std::memory_order_relaxed)) {
+    }
+
+    // Like cyclictest, skip the periods a late wake-up overran instead of catching up with
+    // immediate returns, which would record one stall as a series of large latencies
+    if (latency_ns >= interval_ns) {
+      int64_t missed = latency_ns / interval_ns;
+      overruns_.fetch_add(static_cast<uint64_t>(missed), std::memory_order_relaxed);
+      advance(next, missed * interval_ns);
+    }
+  }
+}
+
+void LatencyProbeNode::publishHistogram()
+{
+  std::vector<uint64_t> counts(bins_.size());
+  uint64_t total = 0;
+  for (size_t i = 0; i < bins_.size(); i++) {
+    counts[i] = bins_[i].exchange(0, std::memory_order_relaxed);
+    total += counts[i];
+  }
+  int64_t max_ns = max_latency_ns_.exchange(0, std::memory_order_relaxed);
+  uint64_t overruns = overruns_.exchange(0, std::memory_order_relaxed);
+
+  // Upper edge of the bin that contains the given fraction of samples
+  auto percentile_us = [&](double fraction) {
+    uint64_t target = static_cast<uint64_t>(fraction * total);
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+      accumulated += counts[i];
+      if (accumulated > target) {
+        return static_cast<int>((i + 1) * bin_width_us_);
+      }
+    }
+    return static_cast<int>(counts.size() * bin_width_us_);
+  };
+
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = "latency_probe";
+  status.hardware_id = std::to_string(cpu_);
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.message = total > 0 ? "OK" : "No samples";
+
+  auto add = [&status](const std::string & key, const std::string & value) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = key;
+    kv.value = value;
+    status.values.push_back(kv);
+  };
+  add("samples", std::to_string(total));
+  add("p50_us", std::to_string(percentile_us(0.5)));
+  add("p99_us", std::to_string(percentile_us(0.99)));
+  add("p999_us", std::to_string(percentile_us(0.999)));
+  add("max_us", std::to_string(max_ns / 1000.0));
+  add("overruns", std::to_string(overruns));
+  add("bin_width_us", std::to_string(bin_width_us_));
+
+  std::string histogram;
+  for (size_t i = 0; i < counts.size(); i++) {
+    histogram += (i ? "," : "") + std::to_string(counts[i]);
+  }
+  add("histogram", histogram);
+
+  diagnostic_msgs::msg::DiagnosticArray array;
+  array.header.stamp = this->now();
+  array.status.push_back(status);
+  histogram_pub_->publish(array);
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::LatencyProbeNode)
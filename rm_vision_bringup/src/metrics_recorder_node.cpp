@@ -0,0 +1,126 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/metrics_recorder_node.hpp"
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include "rm_vision_bringup/proc_stat.hpp"
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace rm_vision_bringup
+{
+MetricsRecorderNode::MetricsRecorderNode(const rclcpp::NodeOptions & options)
+: Node("metrics_recorder", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting MetricsRecorderNode!");
+
+  auto ring_file = this->declare_parameter<std::string>("ring_file", "");
+  int ring_size_mb = this->declare_parameter("ring_size_mb", 32);
+  double period = this->declare_parameter("period", 1.0);
+
+  if (ring_file.empty()) {
+    ring_file = rosHome() + "/metrics.ring";
+  }
+  if (!ring_.open(ring_file, static_cast<size_t>(ring_size_mb) << 20)) {
+    RCLCPP_ERROR(this->get_logger(), "Failed to map metrics file %s", ring_file.c_str());
+    return;
+  }
+  RCLCPP_INFO(this->get_logger(), "Recording metrics to %s", ring_file.c_str());
+
+  // Only counted, the camera publishes one camera info per frame
+  camera_info_sub_ = this->create_subscription<sensor_msgs::msg::CameraInfo>(
+    "/camera_info", rclcpp::SensorDataQoS(),
+    [this](sensor_msgs::msg::CameraInfo::ConstSharedPtr) { frames_++; });
+
+  armors_sub_ = this->create_subscription<auto_aim_interfaces::msg::Armors>(
+    "/detector/armors", rclcpp::SensorDataQoS(),
+    [this](auto_aim_interfaces::msg::Armors::ConstSharedPtr msg) {
+      double age_ms = ageMs(msg->header.stamp);
+      detector_age_ms_.add(age_ms);
+      detector_ages_ms_.push_back(age_ms);
+      armors_ += msg->armors.size();
+    });
+
+  target_sub_ = this->create_subscription<auto_aim_interfaces::msg::Target>(
+    "/tracker/target", rclcpp::SensorDataQoS(),
+    [this](auto_aim_interfaces::msg::Target::ConstSharedPtr msg) {
+      tracker_age_ms_.add(ageMs(msg->header.stamp));
+      tracking_ += msg->tracking;
+    });
+
+  tracker_info_sub_ = this->create_subscription<auto_aim_interfaces::msg::TrackerInfo>(
+    "/tracker/info", 10, [this](auto_aim_interfaces::msg::TrackerInfo::ConstSharedPtr msg) {
+      position_diff_.add(msg->position_diff);
+      yaw_diff_.add(msg->yaw_diff);
+    });
+
+  readCpuTimes(last_cpu_busy_, last_cpu_total_);
+  flush_timer_ = this->create_wall_timer(
+    std::chrono::duration<double>(period), std::bind(&MetricsRecorderNode::flush, this));
+}
+
+double MetricsRecorderNode::ageMs(const builtin_interfaces::msg::Time & stamp)
+{
+  return (this->now() - rclcpp::Time(stamp)).seconds() * 1e3;
+}
+
+void MetricsRecorderNode::flush()
+{
+  MetricsRecord record;
+  record.detector_age_mean_ms = detector_age_ms_.mean();
+  record.detector_age_max_ms = detector_age_ms_.max;
+  record.detector_age_p99_ms = 0.0f;
+  if (!detector_ages_ms_.empty()) {
+    auto p99 = detector_ages_ms_.begin() + detector_ages_ms_.size() * 99 / 100;
+    std::nth_element(detector_ages_ms_.begin(), p99, detector_ages_ms_.end());
+    record.detector_age_p99_ms = *p99;
+  }
+  record.tracker_age_mean_ms = tracker_age_ms_.mean();
+  record.tracker_age_max_ms = tracker_age_ms_.max;
+  record.frames = frames_;
+  record.detections = detector_age_ms_.count;
+  record.armors = armors_;
+  record.tracking_ratio =
+    tracker_age_ms_.count > 0 ? static_cast<float>(tracking_) / tracker_age_ms_.count : 0.0f;
+  record.position_diff_mean = position_diff_.mean();
+  record.yaw_diff_mean = yaw_diff_.mean();
+
+  uint64_t busy = 0, total = 0;
+  if (readCpuTimes(busy, total) && total > last_cpu_total_) {
+    record.cpu_busy_ratio =
+      static_cast<float>(busy - last_cpu_busy_) / (total - last_cpu_total_);
+  } else {
+    record.cpu_busy_ratio = 0.0f;
+  }
+  last_cpu_busy_ = busy;
+  last_cpu_total_ = total;
+  record.max_temperature = maxTemperature();
+  record.cpu_frequency_mhz = meanCpuFrequencyMhz();
+
+  auto stamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  // The direction of the record is unused here
+  ring_.append(0, stamp_ns, reinterpret_cast<const uint8_t *>(&record), sizeof(record));
+
+  detector_age_ms_ = StageStats();
+  detector_ages_ms_.clear();
+  tracker_age_ms_ = StageStats();
+  position_diff_ = StageStats();
+  yaw_diff_ = StageStats();
+  frames_ = 0;
+  armors_ = 0;
+  tracking_ = 0;
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::MetricsRecorderNode)
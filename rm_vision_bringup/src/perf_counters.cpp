@@ -0,0 +1,69 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/perf_counters.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// STD
+#include <cstring>
+
+namespace rm_vision_bringup
+{
+namespace
+{
+constexpr uint64_t kEvents[] = {
+  PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES};
+}  // namespace
+
+PerfCounterGroup::~PerfCounterGroup()
+{
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+bool PerfCounterGroup::open(int tid)
+{
+  for (size_t i = 0; i < fds_.size(); i++) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = kEvents[i];
+    attr.read_format = PERF_FORMAT_GROUP;
+    // User space only, which is allowed for our own processes with the default paranoid level
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    int group_fd = i == 0 ? -1 : fds_[0];
+    fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, 0));
+    if (fds_[i] < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PerfCounterGroup::read(Values & values) const
+{
+  struct
+  {
+    uint64_t nr;
+    uint64_t values[4];
+  } group;
+  if (fds_[0] < 0 || ::read(fds_[0], &group, sizeof(group)) != sizeof(group) || group.nr != 4) {
+    return false;
+  }
+  values.cycles = group.values[0];
+  values.instructions = group.values[1];
+  values.cache_misses = group.values[2];
+  values.branch_misses = group.values[3];
+  return true;
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,44 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/preload_component_manager.hpp"
+
+// STD
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+PreloadComponentManager::PreloadComponentManager(
+  std::weak_ptr<rclcpp::Executor> executor, std::string node_name,
+  const rclcpp::NodeOptions & node_options)
+: ComponentManager(std::move(executor), std::move(node_name), node_options)
+{
+  auto packages = this->declare_parameter("preload_packages", std::vector<std::string>{});
+  preload(packages);
+}
+
+void PreloadComponentManager::preload(const std::vector<std::string> & packages)
+{
+  for (const auto & package : packages) {
+    try {
+      for (const auto & resource : get_component_resources(package)) {
+        auto start = std::chrono::steady_clock::now();
+        // The class loader is cached by library path and reused by load_node
+        create_component_factory(resource);
+        auto elapsed = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+        RCLCPP_INFO(
+          this->get_logger(), "Preloaded %s (%s) in %.1f ms", resource.first.c_str(),
+          resource.second.c_str(), elapsed);
+      }
+    } catch (const rclcpp_components::ComponentManagerException & e) {
+      RCLCPP_ERROR(this->get_logger(), "Failed to preload %s: %s", package.c_str(), e.what());
+    }
+  }
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,242 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/priority_executor.hpp"
+
+#include <rcpputils/scope_exit.hpp>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace rm_vision_bringup
+{
+PriorityExecutor::PriorityExecutor(const rclcpp::ExecutorOptions & options)
+: SingleThreadedExecutor(options)
+{
+}
+
+void PriorityExecutor::setNodePriority(
+  const std::string & node_name, int priority, std::chrono::nanoseconds deadline)
+{
+  NodeStats & stats = nodes_[node_name];
+  stats.priority = priority;
+  stats.deadline = deadline;
+  // Regroup on the next look for work
+  levels_group_count_ = 0;
+}
+
+void PriorityExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false););
+
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    // Work that arrived while the previous callback ran competes by priority
+    updateLevels();
+    wait_for_work(std::chrono::nanoseconds(0));
+    auto looked = std::chrono::steady_clock::now();
+    markReady(looked);
+
+    rclcpp::AnyExecutable any_executable;
+    if (!getNextByPriority(any_executable)) {
+      wait_for_work(std::chrono::nanoseconds(-1));
+      looked = std::chrono::steady_clock::now();
+      markReady(looked);
+      if (!getNextByPriority(any_executable)) {
+        continue;
+      }
+    }
+
+    execute_any_executable(any_executable);
+    record(any_executable, looked);
+  }
+}
+
+void PriorityExecutor::updateLevels()
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (weak_groups_to_nodes_.size() == levels_group_count_) {
+    return;
+  }
+
+  std::map<int, GroupMap, std::greater<int>> levels;
+  for (const auto & group_node : weak_groups_to_nodes_) {
+    auto node = group_node.second.lock();
+    if (!node) {
+      continue;
+    }
+    auto it = nodes_.find(node->get_name());
+    int priority = it == nodes_.end() ? std::numeric_limits<int>::min() : it->second.priority;
+    levels[priority].insert(group_node);
+  }
+  levels_.assign(levels.begin(), levels.end());
+  levels_group_count_ = weak_groups_to_nodes_.size();
+}
+
+void PriorityExecutor::markReady(std::chrono::steady_clock::time_point now)
+{
+  // rcl_wait leaves the handles of ready entities in the wait set and nulls the others
+  ready_handles_.clear();
+  auto collect = [this](const auto * const * entries, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      if (entries[i]) {
+        ready_handles_.push_back(entries[i]);
+      }
+    }
+  };
+  collect(wait_set_.subscriptions, wait_set_.size_of_subscriptions);
+  collect(wait_set_.timers, wait_set_.size_of_timers);
+  collect(wait_set_.services, wait_set_.size_of_services);
+  collect(wait_set_.clients, wait_set_.size_of_clients);
+  auto is_ready = [this](const void * handle) {
+    return std::find(ready_handles_.begin(), ready_handles_.end(), handle) !=
+           ready_handles_.end();
+  };
+
+  // Entities that are no longer ready were executed or had nothing to take
+  ready_scratch_.clear();
+  ready_level_ = levels_.size();
+  size_t level_index = 0;
+  auto mark = [this, now, &level_index](const void * entity) {
+    auto it = findReady(entity);
+    ready_scratch_.emplace_back(entity, it == ready_since_.end() ? now : it->second);
+    ready_level_ = std::min(ready_level_, level_index);
+  };
+  for (; level_index < levels_.size(); level_index++) {
+    for (const auto & group_node : levels_[level_index].second) {
+      auto group = group_node.first.lock();
+      if (!group) {
+        continue;
+      }
+      group->collect_all_ptrs(
+        [&](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+          if (is_ready(subscription->get_subscription_handle().get())) {
+            mark(subscription.get());
+          }
+        },
+        [&](const rclcpp::ServiceBase::SharedPtr & service) {
+          if (is_ready(service->get_service_handle().get())) {
+            mark(service.get());
+          }
+        },
+        [&](const rclcpp::ClientBase::SharedPtr & client) {
+          if (is_ready(client->get_client_handle().get())) {
+            mark(client.get());
+          }
+        },
+        [&](const rclcpp::TimerBase::SharedPtr & timer) {
+          if (is_ready(timer->get_timer_handle().get())) {
+            mark(timer.get());
+          }
+        },
+        // Intra-process subscriptions are waitables
+        [&](const rclcpp::Waitable::SharedPtr & waitable) {
+          if (waitable->is_ready(&wait_set_)) {
+            mark(waitable.get());
+          }
+        });
+    }
+  }
+  ready_since_.swap(ready_scratch_);
+}
+
+PriorityExecutor::ReadyList::iterator PriorityExecutor::findReady(const void * entity)
+{
+  return std::find_if(
+    ready_since_.begin(), ready_since_.end(),
+    [entity](const ReadyList::value_type & ready) {return ready.first == entity;});
+}
+
+bool PriorityExecutor::getNextByPriority(rclcpp::AnyExecutable & any_executable)
+{
+  // One query per look for work: the memory strategy drops the ready handles of every group
+  // outside the map it is given, until the next wait collects them again
+  if (
+    ready_level_ < levels_.size() &&
+    get_next_ready_executable_from_map(any_executable, levels_[ready_level_].second))
+  {
+    return true;
+  }
+  // Work the last look did not attribute to a level, e.g. of a group added since
+  return get_next_ready_executable(any_executable);
+}
+
+void PriorityExecutor::record(
+  const rclcpp::AnyExecutable & any_executable, std::chrono::steady_clock::time_point looked)
+{
+  auto end = std::chrono::steady_clock::now();
+  const void * entity = nullptr;
+  if (any_executable.subscription) {
+    entity = any_executable.subscription.get();
+  } else if (any_executable.timer) {
+    entity = any_executable.timer.get();
+  } else if (any_executable.service) {
+    entity = any_executable.service.get();
+  } else if (any_executable.client) {
+    entity = any_executable.client.get();
+  } else if (any_executable.waitable) {
+    entity = any_executable.waitable.get();
+  }
+  // A further message of the entity is timed from the next look that finds it
+  auto ready = findReady(entity);
+  auto since = looked;
+  if (ready != ready_since_.end()) {
+    since = ready->second;
+    ready_since_.erase(ready);
+  }
+
+  if (!any_executable.node_base) {
+    return;
+  }
+  auto it = nodes_.find(any_executable.node_base->get_name());
+  if (it == nodes_.end()) {
+    return;
+  }
+  auto response = std::chrono::duration_cast<std::chrono::nanoseconds>(end - since);
+
+  NodeStats & stats = it->second;
+  stats.executed.fetch_add(1, std::memory_order_relaxed);
+  if (stats.deadline.count() > 0 && response > stats.deadline) {
+    stats.missed.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (response.count() > stats.worst_ns.load(std::memory_order_relaxed)) {
+    stats.worst_ns.store(response.count(), std::memory_order_relaxed);
+  }
+}
+
+std::string PriorityExecutor::report() const
+{
+  std::vector<std::pair<int, std::string>> lines;
+  for (const auto & node : nodes_) {
+    const NodeStats & stats = node.second;
+    char line[256];
+    std::snprintf(
+      line, sizeof(line),
+      "  %-24s priority %3d  %8lu callbacks  %6lu over %.1f ms  worst %.3f ms",
+      node.first.c_str(), stats.priority,
+      static_cast<unsigned long>(stats.executed.load()),  // NOLINT
+      static_cast<unsigned long>(stats.missed.load()),  // NOLINT
+      std::chrono::duration<double, std::milli>(stats.deadline).count(),
+      stats.worst_ns.load() / 1e6);
+    lines.emplace_back(stats.priority, line);
+  }
+  std::sort(lines.begin(), lines.end(), std::greater<>());
+
+  std::string report = "Callback response times by priority:";
+  for (const auto & line : lines) {
+    report += "\n" + line.second;
+  }
+  return report;
+}
+
+}  // namespace rm_vision_bringup
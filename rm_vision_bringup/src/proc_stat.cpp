@@ -0,0 +1,269 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/proc_stat.hpp"
+
+#include <dirent.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+// STD
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+namespace
+{
+std::vector<int> listNumericEntries(const std::string & path)
+{
+  std::vector<int> ids;
+  DIR * dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return ids;
+  }
+  while (dirent * entry = readdir(dir)) {
+    char * end = nullptr;
+    long id = std::strtol(entry->d_name, &end, 10);
+    if (end != entry->d_name && *end == '\0') {
+      ids.push_back(static_cast<int>(id));
+    }
+  }
+  closedir(dir);
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+std::vector<std::string> readCmdline(int pid)
+{
+  std::ifstream file("/proc/" + std::to_string(pid) + "/cmdline");
+  std::vector<std::string> args;
+  std::string arg;
+  while (std::getline(file, arg, '\0')) {
+    args.push_back(arg);
+  }
+  return args;
+}
+
+std::string basename(const std::string & path)
+{
+  auto pos = path.find_last_of('/');
+  return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+std::string nodeRemap(const std::vector<std::string> & args)
+{
+  const std::string prefix = "__node:=";
+  for (const auto & arg : args) {
+    if (arg.compare(0, prefix.size(), prefix) == 0) {
+      return arg.substr(prefix.size());
+    }
+  }
+  return "";
+}
+
+std::string readFirstLine(const std::string & path)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+// Fields after the parenthesized comm, tokens[0] is field 3 (state) in proc(5)
+std::vector<std::string> readStatFields(const std::string & path, std::string * comm = nullptr)
+{
+  std::string stat = readFirstLine(path);
+  auto open = stat.find('(');
+  auto close = stat.rfind(')');
+  std::vector<std::string> tokens;
+  if (open == std::string::npos || close == std::string::npos || close + 2 > stat.size()) {
+    return tokens;
+  }
+  if (comm != nullptr) {
+    *comm = stat.substr(open + 1, close - open - 1);
+  }
+  std::istringstream fields(stat.substr(close + 2));
+  for (std::string token; fields >> token;) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+}  // namespace
+
+std::vector<int> findProcesses(const std::vector<std::string> & names)
+{
+  std::vector<int> pids;
+  for (int pid : listNumericEntries("/proc")) {
+    auto args = readCmdline(pid);
+    if (args.empty()) {
+      continue;
+    }
+    auto exe = basename(args.front());
+    auto node = nodeRemap(args);
+    for (const auto & name : names) {
+      if (name == exe || (!node.empty() && name == node)) {
+        pids.push_back(pid);
+        break;
+      }
+    }
+  }
+  return pids;
+}
+
+std::string processLabel(int pid)
+{
+  auto args = readCmdline(pid);
+  if (args.empty()) {
+    return std::to_string(pid);
+  }
+  auto node = nodeRemap(args);
+  return node.empty() ? basename(args.front()) : node;
+}
+
+std::vector<int> listThreads(int pid)
+{
+  return listNumericEntries("/proc/" + std::to_string(pid) + "/task");
+}
+
+int parentPid(int pid)
+{
+  auto tokens = readStatFields("/proc/" + std::to_string(pid) + "/stat");
+  return tokens.size() > 1 ? std::stoi(tokens[1]) : 0;
+}
+
+double processStartTime(int pid)
+{
+  auto tokens = readStatFields("/proc/" + std::to_string(pid) + "/stat");
+  if (tokens.size() < 20) {
+    return 0.0;
+  }
+
+  // starttime is in clock ticks of CLOCK_BOOTTIME. btime in /proc/stat only has 1 s resolution,
+  // so convert with the current offset between the wall clock and the boot clock instead
+  timespec realtime{};
+  timespec boottime{};
+  clock_gettime(CLOCK_REALTIME, &realtime);
+  clock_gettime(CLOCK_BOOTTIME, &boottime);
+  double boot_time =
+    (realtime.tv_sec - boottime.tv_sec) + (realtime.tv_nsec - boottime.tv_nsec) / 1e9;
+  return boot_time + std::stod(tokens[19]) / sysconf(_SC_CLK_TCK);
+}
+
+bool readThreadSample(int pid, int tid, ThreadSample & sample)
+{
+  const std::string task = "/proc/" + std::to_string(pid) + "/task/" + std::to_string(tid);
+
+  auto tokens = readStatFields(task + "/stat", &sample.name);
+  if (tokens.size() < 39) {
+    return false;
+  }
+
+  sample.pid = pid;
+  sample.tid = tid;
+  sample.nice = std::stoi(tokens[16]);
+  sample.processor = std::stoi(tokens[36]);
+  sample.rt_priority = std::stoi(tokens[37]);
+  sample.policy = std::stoi(tokens[38]);
+
+  std::ifstream schedstat(task + "/schedstat");
+  if (!(schedstat >> sample.cpu_time_ns >> sample.run_delay_ns >> sample.timeslices)) {
+    return false;
+  }
+
+  std::ifstream status(task + "/status");
+  for (std::string line; std::getline(status, line);) {
+    auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    auto key = line.substr(0, colon);
+    auto begin = line.find_first_not_of(" \t", colon + 1);
+    auto value = begin == std::string::npos ? std::string() : line.substr(begin);
+    if (key == "Cpus_allowed_list") {
+      sample.cpus_allowed = value;
+    } else if (key == "voluntary_ctxt_switches") {
+      sample.voluntary_ctxt_switches = std::stoull(value);
+    } else if (key == "nonvoluntary_ctxt_switches") {
+      sample.nonvoluntary_ctxt_switches = std::stoull(value);
+    }
+  }
+
+  return true;
+}
+
+std::string policyName(int policy)
+{
+  switch (policy) {
+    case SCHED_OTHER:
+      return "OTHER";
+    case SCHED_FIFO:
+      return "FIFO";
+    case SCHED_RR:
+      return "RR";
+    case SCHED_BATCH:
+      return "BATCH";
+    case SCHED_IDLE:
+      return "IDLE";
+    default:
+      return std::to_string(policy);
+  }
+}
+
+bool readCpuTimes(uint64_t & busy, uint64_t & total)
+{
+  std::istringstream line(readFirstLine("/proc/stat"));
+  std::string cpu;
+  line >> cpu;
+  if (cpu != "cpu") {
+    return false;
+  }
+  // user nice system idle iowait irq softirq steal
+  uint64_t times[8] = {};
+  for (auto & time : times) {
+    line >> time;
+  }
+  total = 0;
+  for (auto time : times) {
+    total += time;
+  }
+  busy = total - times[3] - times[4];
+  return true;
+}
+
+double maxTemperature()
+{
+  double max = NAN;
+  for (int zone = 0;; zone++) {
+    std::ifstream file("/sys/class/thermal/thermal_zone" + std::to_string(zone) + "/temp");
+    long millidegrees;
+    if (!(file >> millidegrees)) {
+      break;
+    }
+    max = std::isnan(max) ? millidegrees / 1000.0 : std::max(max, millidegrees / 1000.0);
+  }
+  return max;
+}
+
+double meanCpuFrequencyMhz()
+{
+  double sum = 0.0;
+  int count = 0;
+  for (int cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); cpu++) {
+    std::ifstream file(
+      "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_cur_freq");
+    long khz;
+    if (file >> khz) {
+      sum += khz / 1000.0;
+      count++;
+    }
+  }
+  return count > 0 ? sum / count : NAN;
+}
+
+}  // namespace rm_vision_bringup
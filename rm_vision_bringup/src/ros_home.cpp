@@ -0,0 +1,21 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/ros_home.hpp"
+
+// STD
+#include <cstdlib>
+#include <string>
+
+namespace rm_vision_bringup
+{
+std::string rosHome()
+{
+  const char * ros_home = std::getenv("ROS_HOME");
+  if (ros_home != nullptr && ros_home[0] != '\0') {
+    return ros_home;
+  }
+  const char * home = std::getenv("HOME");
+  return std::string(home ? home : "/tmp") + "/.ros";
+}
+
+}  // namespace rm_vision_bringup
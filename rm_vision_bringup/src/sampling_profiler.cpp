@@ -0,0 +1,199 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/sampling_profiler.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// STD
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+namespace
+{
+// The handler announces itself before looking up the profiler, so stop() can wait for it
+std::atomic<SamplingProfiler *> active_profiler{nullptr};
+std::atomic<int> handlers_in_flight{0};
+
+// Frames of the handler itself and of the kernel's signal trampoline
+constexpr int kSkippedFrames = 2;
+
+std::string threadName(int tid)
+{
+  std::ifstream file("/proc/self/task/" + std::to_string(tid) + "/comm");
+  std::string name;
+  if (!std::getline(file, name)) {
+    // The thread exited before the profile was written
+    name = "tid " + std::to_string(tid);
+  }
+  return name;
+}
+
+std::string symbolName(void * address)
+{
+  Dl_info info;
+  if (!dladdr(address, &info) || !info.dli_fname) {
+    return "??";
+  }
+  std::string name;
+  if (info.dli_sname) {
+    int status = 0;
+    char * demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    name = status == 0 ? demangled : info.dli_sname;
+    std::free(demangled);
+  } else {
+    // Static function, show where it is so it can be resolved with addr2line
+    std::string library = info.dli_fname;
+    char offset[32];
+    snprintf(
+      offset, sizeof(offset), "+0x%lx",
+      static_cast<unsigned long>(  // NOLINT
+        reinterpret_cast<char *>(address) - reinterpret_cast<char *>(info.dli_fbase)));
+    name = library.substr(library.rfind('/') + 1) + offset;
+  }
+  // ';' separates frames in the collapsed format
+  std::replace(name.begin(), name.end(), ';', ':');
+  return name;
+}
+}  // namespace
+
+SamplingProfiler::~SamplingProfiler()
+{
+  stop();
+}
+
+bool SamplingProfiler::start(int frequency, size_t max_samples)
+{
+  if (frequency <= 0 || max_samples == 0) {
+    return false;
+  }
+  SamplingProfiler * expected = nullptr;
+  if (!active_profiler.compare_exchange_strong(expected, this)) {
+    return false;
+  }
+
+  samples_.assign(max_samples, Sample());
+  next_ = 0;
+
+  // The first backtrace() loads the unwinder, which must not happen inside the handler
+  void * warm_up[1];
+  backtrace(warm_up, 1);
+
+  struct sigaction action = {};
+  action.sa_handler = &SamplingProfiler::handleSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGPROF, &action, nullptr);
+
+  itimerval timer = {};
+  timer.it_interval.tv_usec = std::max(1, 1000000 / frequency);
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_PROF, &timer, nullptr);
+
+  running_ = true;
+  return true;
+}
+
+void SamplingProfiler::stop()
+{
+  if (!running_) {
+    return;
+  }
+  itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  active_profiler = nullptr;
+  while (handlers_in_flight > 0) {
+    std::this_thread::yield();
+  }
+  // A SIGPROF still pending on some thread must not terminate the process
+  signal(SIGPROF, SIG_IGN);
+  running_ = false;
+}
+
+void SamplingProfiler::handleSignal(int)
+{
+  int saved_errno = errno;
+  handlers_in_flight++;
+  SamplingProfiler * self = active_profiler.load();
+  if (self) {
+    size_t i = self->next_.fetch_add(1, std::memory_order_relaxed);
+    if (i < self->samples_.size()) {
+      Sample & sample = self->samples_[i];
+      sample.tid = static_cast<int>(syscall(SYS_gettid));
+      sample.depth = backtrace(sample.frames, kMaxDepth);
+    }
+  }
+  handlers_in_flight--;
+  errno = saved_errno;
+}
+
+size_t SamplingProfiler::dropped() const
+{
+  size_t taken = next_;
+  return taken > samples_.size() ? taken - samples_.size() : 0;
+}
+
+long SamplingProfiler::writeCollapsed(
+  const std::string & path, const std::vector<std::string> & threads) const
+{
+  std::ofstream file(path);
+  if (!file) {
+    return -1;
+  }
+
+  std::map<int, std::string> thread_names;
+  std::map<void *, std::string> symbols;
+  std::map<std::string, long> stacks;
+  long written = 0;
+
+  size_t count = std::min(next_.load(), samples_.size());
+  for (size_t i = 0; i < count; i++) {
+    const Sample & sample = samples_[i];
+    if (!thread_names.count(sample.tid)) {
+      thread_names[sample.tid] = threadName(sample.tid);
+    }
+    const std::string & thread = thread_names[sample.tid];
+    if (
+      !threads.empty() && std::none_of(threads.begin(), threads.end(), [&](const std::string & t) {
+        return thread.find(t) != std::string::npos;
+      })) {
+      continue;
+    }
+
+    std::string stack = thread;
+    for (int j = sample.depth - 1; j >= kSkippedFrames; j--) {
+      // Return addresses point after the call, look up the call instruction itself
+      void * address = sample.frames[j];
+      if (j > kSkippedFrames) {
+        address = reinterpret_cast<char *>(address) - 1;
+      }
+      auto it = symbols.find(address);
+      if (it == symbols.end()) {
+        it = symbols.emplace(address, symbolName(address)).first;
+      }
+      stack += ";" + it->second;
+    }
+    stacks[stack]++;
+    written++;
+  }
+
+  for (const auto & stack : stacks) {
+    file << stack.first << ' ' << stack.second << '\n';
+  }
+  return written;
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,115 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/sampling_profiler_node.hpp"
+
+#include <unistd.h>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/proc_stat.hpp"
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace rm_vision_bringup
+{
+SamplingProfilerNode::SamplingProfilerNode(const rclcpp::NodeOptions & options)
+: Node("sampling_profiler", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting SamplingProfilerNode!");
+
+  // Read when a profile is started, so they can be changed with ros2 param set in between
+  this->declare_parameter("frequency", 999);
+  this->declare_parameter("duration", 10.0);
+  this->declare_parameter("threads", std::vector<std::string>{});
+
+  output_dir_ = this->declare_parameter<std::string>("output_dir", "");
+  if (output_dir_.empty()) {
+    output_dir_ = rosHome();
+  }
+
+  using std::placeholders::_1;
+  using std::placeholders::_2;
+  start_srv_ = this->create_service<std_srvs::srv::Trigger>(
+    "~/start", std::bind(&SamplingProfilerNode::startCallback, this, _1, _2));
+  stop_srv_ = this->create_service<std_srvs::srv::Trigger>(
+    "~/stop", std::bind(&SamplingProfilerNode::stopCallback, this, _1, _2));
+}
+
+void SamplingProfilerNode::startCallback(
+  const std_srvs::srv::Trigger::Request::SharedPtr,
+  std_srvs::srv::Trigger::Response::SharedPtr response)
+{
+  int frequency = this->get_parameter("frequency").as_int();
+  double duration = this->get_parameter("duration").as_double();
+
+  // Room for every core being busy the whole time, allocated before the timer is armed
+  size_t max_samples = static_cast<size_t>(
+    frequency * duration * std::max(1u, std::thread::hardware_concurrency()));
+  if (profiler_.running() || !profiler_.start(frequency, max_samples)) {
+    response->success = false;
+    response->message = "A profile of this process is already running";
+    return;
+  }
+
+  char stamp[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+  output_file_ = output_dir_ + "/profile_" + processLabel(getpid()) + "_" + stamp + ".folded";
+
+  stop_timer_ = this->create_wall_timer(std::chrono::duration<double>(duration), [this]() {
+      stop_timer_->cancel();
+      RCLCPP_INFO(this->get_logger(), "%s", finish().c_str());
+    });
+
+  response->success = true;
+  response->message = "Profiling for " + std::to_string(duration) + " s into " + output_file_;
+  RCLCPP_INFO(this->get_logger(), "%s", response->message.c_str());
+}
+
+void SamplingProfilerNode::stopCallback(
+  const std_srvs::srv::Trigger::Request::SharedPtr,
+  std_srvs::srv::Trigger::Response::SharedPtr response)
+{
+  if (!profiler_.running()) {
+    response->success = false;
+    response->message = "No profile running";
+    return;
+  }
+  stop_timer_->cancel();
+  response->success = true;
+  response->message = finish();
+}
+
+std::string SamplingProfilerNode::finish()
+{
+  profiler_.stop();
+
+  // Symbolizing runs on the executor thread, the hot path is stalled for a moment once
+  auto threads = this->get_parameter("threads").as_string_array();
+  long samples = profiler_.writeCollapsed(output_file_, threads);
+  if (samples < 0) {
+    return "Failed to write " + output_file_;
+  }
+
+  std::string message = "Wrote " + std::to_string(samples) + " samples to " + output_file_;
+  if (profiler_.dropped() > 0) {
+    message += ", buffer full, " + std::to_string(profiler_.dropped()) + " samples dropped";
+  }
+  return message;
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::SamplingProfilerNode)
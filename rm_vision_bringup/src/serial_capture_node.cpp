@@ -0,0 +1,200 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/serial_capture_node.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// STD
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace rm_vision_bringup
+{
+namespace
+{
+// Binary usbmon interface, see Documentation/usb/usbmon.rst in the kernel tree
+struct UsbmonPacket
+{
+  uint64_t id;
+  uint8_t type;
+  uint8_t xfer_type;
+  uint8_t epnum;
+  uint8_t devnum;
+  uint16_t busnum;
+  char flag_setup;
+  char flag_data;
+  int64_t ts_sec;
+  int32_t ts_usec;
+  int32_t status;
+  uint32_t length;
+  uint32_t len_cap;
+  uint8_t setup[8];
+  int32_t interval;
+  int32_t start_frame;
+  uint32_t xfer_flags;
+  uint32_t ndesc;
+};
+static_assert(sizeof(UsbmonPacket) == 64, "usbmon packet header layout");
+
+struct MonGetArg
+{
+  UsbmonPacket * hdr;
+  void * data;
+  size_t alloc;
+};
+
+constexpr unsigned long kMonIocxGetx = _IOW(0x92, 10, MonGetArg);
+constexpr uint8_t kXferBulk = 3;
+constexpr uint8_t kEndpointIn = 0x80;
+
+constexpr uint8_t kDirectionTx = 0;
+constexpr uint8_t kDirectionRx = 1;
+
+int readNumber(const std::string & path)
+{
+  std::ifstream file(path);
+  int value = -1;
+  file >> value;
+  return value;
+}
+}  // namespace
+
+SerialCaptureNode::SerialCaptureNode(const rclcpp::NodeOptions & options)
+: Node("serial_capture", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting SerialCaptureNode!");
+
+  device_name_ = this->declare_parameter<std::string>("device_name", "/dev/ttyACM0");
+  auto ring_file = this->declare_parameter<std::string>("ring_file", "");
+  int ring_size_mb = this->declare_parameter("ring_size_mb", 16);
+
+  if (ring_file.empty()) {
+    ring_file = rosHome() + "/serial_capture.ring";
+  }
+  if (!ring_.open(ring_file, static_cast<size_t>(ring_size_mb) << 20)) {
+    RCLCPP_ERROR(this->get_logger(), "Failed to map capture file %s", ring_file.c_str());
+    return;
+  }
+  RCLCPP_INFO(this->get_logger(), "Capturing %s to %s", device_name_.c_str(), ring_file.c_str());
+
+  capture_thread_ = std::thread(&SerialCaptureNode::captureLoop, this);
+}
+
+SerialCaptureNode::~SerialCaptureNode()
+{
+  running_ = false;
+  if (capture_thread_.joinable()) {
+    capture_thread_.join();
+  }
+}
+
+bool SerialCaptureNode::resolveDevice(int & busnum, int & devnum) const
+{
+  // /sys/class/tty/ttyACM0/device points at the CDC interface, its parent is the USB device
+  auto tty = device_name_.substr(device_name_.find_last_of('/') + 1);
+  char * interface = realpath(("/sys/class/tty/" + tty + "/device").c_str(), nullptr);
+  if (interface == nullptr) {
+    return false;
+  }
+  std::string usb_device(interface);
+  free(interface);
+  usb_device = usb_device.substr(0, usb_device.find_last_of('/'));
+
+  busnum = readNumber(usb_device + "/busnum");
+  devnum = readNumber(usb_device + "/devnum");
+  return busnum > 0 && devnum > 0;
+}
+
+void SerialCaptureNode::captureLoop()
+{
+  std::vector<uint8_t> buffer(1 << 16);
+  int fd = -1;
+  int busnum = -1;
+  int devnum = -1;
+  auto next_device_check = std::chrono::steady_clock::now();
+
+  while (running_) {
+    // (Re)attach whenever the MCU is re-enumerated
+    if (fd < 0) {
+      if (!resolveDevice(busnum, devnum)) {
+        RCLCPP_WARN_THROTTLE(
+          this->get_logger(), *this->get_clock(), 5000, "%s not found", device_name_.c_str());
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        continue;
+      }
+      auto usbmon = "/dev/usbmon" + std::to_string(busnum);
+      fd = open(usbmon.c_str(), O_RDONLY);
+      if (fd < 0) {
+        RCLCPP_WARN_THROTTLE(
+          this->get_logger(), *this->get_clock(), 5000,
+          "Failed to open %s, is the usbmon module loaded?", usbmon.c_str());
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        continue;
+      }
+      RCLCPP_INFO(this->get_logger(), "Attached to %s device %d", usbmon.c_str(), devnum);
+      next_device_check = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    }
+
+    // Checked on a deadline rather than on poll timeouts, traffic of other devices on the bus
+    // keeps usbmon readable so poll may never time out
+    auto now = std::chrono::steady_clock::now();
+    if (now >= next_device_check) {
+      int current_bus, current_dev;
+      if (!resolveDevice(current_bus, current_dev) || current_dev != devnum) {
+        close(fd);
+        fd = -1;
+        continue;
+      }
+      next_device_check = now + std::chrono::seconds(1);
+    }
+
+    pollfd pfd{fd, POLLIN, 0};
+    auto timeout =
+      std::chrono::duration_cast<std::chrono::milliseconds>(next_device_check - now).count() + 1;
+    int ready = poll(&pfd, 1, static_cast<int>(timeout));
+    if (ready == 0) {
+      continue;
+    }
+
+    UsbmonPacket hdr;
+    MonGetArg arg{&hdr, buffer.data(), buffer.size()};
+    if (ready < 0 || ioctl(fd, kMonIocxGetx, &arg) < 0) {
+      continue;
+    }
+    if (hdr.busnum != busnum || hdr.devnum != devnum || hdr.xfer_type != kXferBulk) {
+      continue;
+    }
+
+    // Host to MCU data is carried by the submission, MCU to host data by the completion
+    bool in = hdr.epnum & kEndpointIn;
+    if ((!in && hdr.type == 'S') || (in && hdr.type == 'C')) {
+      if (hdr.len_cap > 0) {
+        int64_t stamp_ns = hdr.ts_sec * 1000000000LL + hdr.ts_usec * 1000LL;
+        ring_.append(in ? kDirectionRx : kDirectionTx, stamp_ns, buffer.data(), hdr.len_cap);
+      }
+    }
+  }
+
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::SerialCaptureNode)
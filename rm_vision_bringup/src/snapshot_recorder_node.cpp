@@ -0,0 +1,278 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/snapshot_recorder_node.hpp"
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/capture_ring.hpp"
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace rm_vision_bringup
+{
+namespace
+{
+int64_t wallNowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+class SnapshotWriter
+{
+public:
+  explicit SnapshotWriter(const std::string & path) : file_(path, std::ios::binary) {}
+
+  explicit operator bool() const { return static_cast<bool>(file_); }
+
+  template<typename T>
+  void put(T value)
+  {
+    file_.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  void putRaw(const char * data, size_t size) { file_.write(data, size); }
+
+  void putString(const std::string & s)
+  {
+    put(static_cast<uint16_t>(s.size()));
+    file_.write(s.data(), s.size());
+  }
+
+  void putBytes(const std::vector<uint8_t> & bytes)
+  {
+    put(static_cast<uint32_t>(bytes.size()));
+    file_.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  }
+
+private:
+  std::ofstream file_;
+};
+}  // namespace
+
+SnapshotRecorderNode::SnapshotRecorderNode(const rclcpp::NodeOptions & options)
+: Node("snapshot_recorder", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting SnapshotRecorderNode!");
+
+  topics_ = this->declare_parameter(
+    "topics", std::vector<std::string>{
+                "/detector/armors", "/tracker/target", "/tracker/info", "/tf", "/tf_static"});
+  depth_ = this->declare_parameter("depth", 100);
+  output_dir_ = this->declare_parameter<std::string>("output_dir", "");
+  serial_ring_file_ = this->declare_parameter<std::string>("serial_ring_file", "");
+  serial_bytes_ = this->declare_parameter("serial_bytes", 65536);
+
+  std::string ros_home = rosHome();
+  if (output_dir_.empty()) {
+    output_dir_ = ros_home;
+  }
+  if (serial_ring_file_.empty()) {
+    serial_ring_file_ = ros_home + "/serial_capture.ring";
+  }
+
+  parameter_event_sub_ = this->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", rclcpp::ParameterEventsQoS(),
+    std::bind(&SnapshotRecorderNode::parameterEventCallback, this, std::placeholders::_1));
+
+  dump_srv_ = this->create_service<std_srvs::srv::Trigger>(
+    "~/dump", std::bind(
+                &SnapshotRecorderNode::dumpCallback, this, std::placeholders::_1,
+                std::placeholders::_2));
+
+  discover_timer_ = this->create_wall_timer(std::chrono::seconds(1), [this]() {
+    discoverTopics();
+    discoverNodes();
+  });
+}
+
+void SnapshotRecorderNode::discoverTopics()
+{
+  for (const auto & topic : topics_) {
+    if (rings_.count(topic)) {
+      continue;
+    }
+    auto publishers = this->get_publishers_info_by_topic(topic);
+    if (publishers.empty()) {
+      continue;
+    }
+
+    TopicRing & ring = rings_[topic];
+    ring.type = publishers.front().topic_type();
+    ring.stamps.resize(depth_);
+    ring.messages.resize(depth_);
+    for (auto & message : ring.messages) {
+      message.reserve(1024);
+    }
+
+    // Static transforms are only sent once to late joiners that ask for them
+    auto qos = topic == "/tf_static" ? rclcpp::QoS(depth_).transient_local() :
+                                       rclcpp::SensorDataQoS();
+    ring.sub = this->create_generic_subscription(
+      topic, ring.type, qos, [&ring](std::shared_ptr<rclcpp::SerializedMessage> msg) {
+        const auto & serialized = msg->get_rcl_serialized_message();
+        ring.stamps[ring.next] = wallNowNs();
+        ring.messages[ring.next].assign(
+          serialized.buffer, serialized.buffer + serialized.buffer_length);
+        ring.next = (ring.next + 1) % ring.messages.size();
+        ring.count = std::min(ring.count + 1, ring.messages.size());
+      });
+    RCLCPP_INFO(this->get_logger(), "Recording %s [%s]", topic.c_str(), ring.type.c_str());
+  }
+}
+
+void SnapshotRecorderNode::discoverNodes()
+{
+  auto names = this->get_node_names();
+  std::set<std::string> live(names.begin(), names.end());
+
+  // A restarted node declares its parameters again, fetch them when it comes back.
+  // The last values of a node that is gone stay in the snapshot.
+  for (auto it = parameter_clients_.begin(); it != parameter_clients_.end(); ) {
+    if (live.count(it->first)) {
+      ++it;
+    } else {
+      fetched_nodes_.erase(it->first);
+      it = parameter_clients_.erase(it);
+    }
+  }
+
+  for (const auto & name : live) {
+    // Hidden nodes such as the ros2 cli daemon start with an underscore
+    if (fetched_nodes_.count(name) || name.find("/_") != std::string::npos) {
+      continue;
+    }
+    auto & client = parameter_clients_[name];
+    if (!client) {
+      client = std::make_shared<rclcpp::AsyncParametersClient>(this, name);
+    }
+    // Nodes without parameter services, or not discovered yet, are checked again next time
+    if (client->service_is_ready()) {
+      fetchParameters(name, client);
+    }
+  }
+}
+
+void SnapshotRecorderNode::fetchParameters(
+  const std::string & node_name, const rclcpp::AsyncParametersClient::SharedPtr & client)
+{
+  fetched_nodes_.insert(node_name);
+  // Drops what a previous run of the node left, events from now on are kept over the result
+  parameters_[node_name].clear();
+  changed_since_fetch_[node_name].clear();
+
+  client->list_parameters(
+    {}, rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE,
+    [this, client, node_name](
+      std::shared_future<rcl_interfaces::msg::ListParametersResult> listed) {
+      auto names = listed.get().names;
+      client->get_parameters(
+        names, [this, node_name](std::shared_future<std::vector<rclcpp::Parameter>> got) {
+          auto & node = parameters_[node_name];
+          const auto & changed = changed_since_fetch_[node_name];
+          for (const auto & parameter : got.get()) {
+            if (!changed.count(parameter.get_name())) {
+              node[parameter.get_name()] = parameter.value_to_string();
+            }
+          }
+        });
+    });
+}
+
+void SnapshotRecorderNode::parameterEventCallback(
+  const rcl_interfaces::msg::ParameterEvent::SharedPtr event)
+{
+  auto & node = parameters_[event->node];
+  auto & changed = changed_since_fetch_[event->node];
+  for (const auto & p : event->new_parameters) {
+    node[p.name] = rclcpp::Parameter::from_parameter_msg(p).value_to_string();
+    changed.insert(p.name);
+  }
+  for (const auto & p : event->changed_parameters) {
+    node[p.name] = rclcpp::Parameter::from_parameter_msg(p).value_to_string();
+    changed.insert(p.name);
+  }
+  for (const auto & p : event->deleted_parameters) {
+    node.erase(p.name);
+    changed.insert(p.name);
+  }
+}
+
+void SnapshotRecorderNode::dumpCallback(
+  const std_srvs::srv::Trigger::Request::SharedPtr,
+  std_srvs::srv::Trigger::Response::SharedPtr response)
+{
+  int64_t stamp_ns = wallNowNs();
+  char stamp[32];
+  std::time_t now = stamp_ns / 1000000000;
+  std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+  std::string path = output_dir_ + "/snapshot_" + stamp + ".bin";
+
+  SnapshotWriter writer(path);
+  if (!writer) {
+    response->success = false;
+    response->message = "Failed to open " + path;
+    return;
+  }
+  writer.putRaw("RMSNAP1", 8);
+  writer.put(stamp_ns);
+
+  for (const auto & topic : rings_) {
+    const TopicRing & ring = topic.second;
+    writer.put(kTopicSection);
+    writer.putString(topic.first);
+    writer.putString(ring.type);
+    writer.put(static_cast<uint32_t>(ring.count));
+    // Oldest first
+    size_t size = ring.messages.size();
+    for (size_t i = 0; i < ring.count; i++) {
+      size_t slot = (ring.next + size - ring.count + i) % size;
+      writer.put(ring.stamps[slot]);
+      writer.putBytes(ring.messages[slot]);
+    }
+  }
+
+  for (const auto & node : parameters_) {
+    writer.put(kParameterSection);
+    writer.putString(node.first);
+    writer.put(static_cast<uint32_t>(node.second.size()));
+    for (const auto & parameter : node.second) {
+      writer.putString(parameter.first);
+      writer.putString(parameter.second);
+    }
+  }
+
+  uint64_t serial_start;
+  std::vector<uint8_t> serial;
+  bool has_serial = CaptureRing::readTail(serial_ring_file_, serial_bytes_, serial_start, serial);
+  if (has_serial) {
+    writer.put(kSerialSection);
+    writer.put(serial_start);
+    writer.putBytes(serial);
+  }
+
+  response->success = static_cast<bool>(writer);
+  response->message = (writer ? "Wrote " : "Failed to write ") + path;
+  if (!has_serial) {
+    response->message += ", no serial capture in " + serial_ring_file_;
+  }
+  RCLCPP_INFO(this->get_logger(), "%s", response->message.c_str());
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::SnapshotRecorderNode)
@@ -0,0 +1,30 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/stage_stats.hpp"
+
+// STD
+#include <algorithm>
+#include <string>
+
+namespace rm_vision_bringup
+{
+void StageStats::add(double value)
+{
+  count++;
+  sum += value;
+  max = std::max(max, value);
+}
+
+void StageStats::report(diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & name)
+{
+  diagnostic_msgs::msg::KeyValue kv;
+  kv.key = name + "_mean";
+  kv.value = std::to_string(mean());
+  status.values.push_back(kv);
+  kv.key = name + "_max";
+  kv.value = std::to_string(max);
+  status.values.push_back(kv);
+  *this = StageStats();
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,252 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/startup_profiler_node.hpp"
+
+#include <unistd.h>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rm_vision_bringup/proc_stat.hpp"
+#include "rm_vision_bringup/ros_home.hpp"
+
+namespace rm_vision_bringup
+{
+namespace
+{
+double wallNow()
+{
+  return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+}  // namespace
+
+StartupProfilerNode::StartupProfilerNode(const rclcpp::NodeOptions & options)
+: Node("startup_profiler", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting StartupProfilerNode!");
+
+  processes_ = this->declare_parameter(
+    "processes", std::vector<std::string>{
+                   "robot_state_publisher", "camera_detector_container", "armor_tracker_node",
+                   "rm_serial_driver_node"});
+  nodes_ = this->declare_parameter(
+    "nodes",
+    std::vector<std::string>{"camera_node", "armor_detector", "armor_tracker", "serial_driver"});
+  topics_ = this->declare_parameter(
+    "topics", std::vector<std::string>{"/camera_info", "/detector/armors", "/tracker/target"});
+  timeout_ = this->declare_parameter("timeout", 30.0);
+  max_restart_gap_ = this->declare_parameter("max_restart_gap", 10.0);
+  auto history_dir = this->declare_parameter<std::string>("history_dir", "");
+  if (history_dir.empty()) {
+    history_dir = rosHome();
+  }
+  history_file_ = history_dir + "/startup_history.csv";
+  alive_file_ = history_dir + "/startup_profiler.alive";
+
+  // We are spawned by the launch process, its start is the origin of the timeline
+  launch_time_ = processStartTime(parentPid(getpid()));
+  record("ros2 launch started", launch_time_);
+  record("startup_profiler up", wallNow());
+
+  report_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "~/report", rclcpp::QoS(1).transient_local());
+
+  // Read before our own heartbeat overwrites it
+  std::ifstream(alive_file_) >> previous_alive_;
+  heartbeat();
+  heartbeat_timer_ = this->create_wall_timer(
+    std::chrono::seconds(1), std::bind(&StartupProfilerNode::heartbeat, this));
+
+  poll_timer_ = this->create_wall_timer(
+    std::chrono::milliseconds(10), std::bind(&StartupProfilerNode::poll, this));
+}
+
+void StartupProfilerNode::poll()
+{
+  auto now = wallNow();
+
+  for (int pid : findProcesses(processes_)) {
+    auto label = processLabel(pid) + " spawned";
+    if (!recorded_.count(label)) {
+      record(label, processStartTime(pid));
+    }
+  }
+
+  auto node_names = this->get_node_names();
+  for (const auto & node : nodes_) {
+    auto label = node + " node up";
+    if (
+      !recorded_.count(label) &&
+      std::find(node_names.begin(), node_names.end(), "/" + node) != node_names.end()) {
+      record(label, now);
+    }
+  }
+
+  for (const auto & topic : topics_) {
+    if (topic_subs_.count(topic)) {
+      continue;
+    }
+    auto publishers = this->get_publishers_info_by_topic(topic);
+    if (publishers.empty()) {
+      continue;
+    }
+    record(topic + " advertised", now);
+    // Best effort is compatible with both reliable and sensor data publishers
+    topic_subs_[topic] = this->create_generic_subscription(
+      topic, publishers.front().topic_type(), rclcpp::SensorDataQoS(),
+      [this, topic](std::shared_ptr<rclcpp::SerializedMessage>) {
+        if (received_topics_.insert(topic).second) {
+          record(topic + " first message", wallNow());
+        }
+      });
+  }
+
+  // Subscriptions are only needed for the first message
+  for (const auto & topic : received_topics_) {
+    topic_subs_[topic].reset();
+  }
+
+  if (received_topics_.size() == topics_.size() || now - launch_time_ > timeout_) {
+    finish();
+  }
+}
+
+void StartupProfilerNode::record(const std::string & label, double time)
+{
+  recorded_.insert(label);
+  events_.push_back({time, label});
+}
+
+void StartupProfilerNode::finish()
+{
+  poll_timer_->cancel();
+  for (auto & sub : topic_subs_) {
+    sub.second.reset();
+  }
+
+  std::sort(events_.begin(), events_.end(), [](const Event & a, const Event & b) {
+    return a.time < b.time;
+  });
+
+  diagnostic_msgs::msg::DiagnosticArray array;
+  array.header.stamp = this->now();
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = "startup";
+  status.hardware_id = "rm_vision";
+
+  std::string report = "Startup timeline:\n";
+  char line[256];
+  double prev = launch_time_;
+  for (const auto & event : events_) {
+    std::snprintf(
+      line, sizeof(line), "  +%7.3f s (%+7.3f s)  %s\n", event.time - launch_time_,
+      event.time - prev, event.label.c_str());
+    report += line;
+    prev = event.time;
+
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = event.label;
+    kv.value = std::to_string(event.time - launch_time_);
+    status.values.push_back(kv);
+  }
+
+  std::vector<std::string> missing;
+  for (const auto & topic : topics_) {
+    if (!received_topics_.count(topic)) {
+      missing.push_back(topic);
+    }
+  }
+  if (missing.empty()) {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    std::snprintf(
+      line, sizeof(line), "Pipeline ready %.3f s after launch",
+      events_.back().time - launch_time_);
+    status.message = line;
+  } else {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::WARN;
+    status.message = "No message within timeout on:";
+    for (const auto & topic : missing) {
+      status.message += " " + topic;
+    }
+  }
+  report += status.message;
+
+  double ready_time = missing.empty() ? events_.back().time - launch_time_ : -1.0;
+  // Includes the time the crashed run took to exit and the container restart.
+  // A previous run seen long before this launch was stopped, not crashed and restarted.
+  double gap = launch_time_ - previous_alive_;
+  bool restarted = previous_alive_ > 0.0 && gap >= 0.0 && gap <= max_restart_gap_;
+  double restart_time =
+    missing.empty() && restarted ? events_.back().time - previous_alive_ : -1.0;
+  double median = appendHistory(ready_time, restart_time);
+  if (restart_time >= 0.0) {
+    std::snprintf(
+      line, sizeof(line), "\nReady %.3f s after the previous run was last seen", restart_time);
+    report += line;
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = "restart to ready";
+    kv.value = std::to_string(restart_time);
+    status.values.push_back(kv);
+  }
+  if (median > 0.0) {
+    std::snprintf(line, sizeof(line), "\nMedian launch to ready of previous runs %.3f s", median);
+    report += line;
+  }
+
+  RCLCPP_INFO(this->get_logger(), "%s", report.c_str());
+  array.status.push_back(status);
+  report_pub_->publish(array);
+}
+
+void StartupProfilerNode::heartbeat()
+{
+  // Replaced atomically, a crash never leaves a truncated file behind
+  auto tmp_file = alive_file_ + ".tmp";
+  {
+    std::ofstream file(tmp_file);
+    file << std::fixed << wallNow();
+  }
+  std::rename(tmp_file.c_str(), alive_file_.c_str());
+}
+
+double StartupProfilerNode::appendHistory(double ready_time, double restart_time)
+{
+  // Columns: launch time (s since epoch), launch to ready (s), last seen to ready (s),
+  // -1 where not available
+  std::vector<double> previous;
+  std::ifstream history(history_file_);
+  for (std::string row; std::getline(history, row);) {
+    double launch, ready;
+    if (std::sscanf(row.c_str(), "%lf,%lf", &launch, &ready) == 2 && ready >= 0.0) {
+      previous.push_back(ready);
+    }
+  }
+
+  std::ofstream file(history_file_, std::ios::app);
+  char row[128];
+  std::snprintf(row, sizeof(row), "%.3f,%.3f,%.3f\n", launch_time_, ready_time, restart_time);
+  file << row;
+
+  if (previous.empty()) {
+    return 0.0;
+  }
+  std::nth_element(previous.begin(), previous.begin() + previous.size() / 2, previous.end());
+  return previous[previous.size() / 2];
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::StartupProfilerNode)
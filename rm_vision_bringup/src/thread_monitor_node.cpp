@@ -0,0 +1,220 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/thread_monitor_node.hpp"
+
+// STD
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rm_vision_bringup
+{
+ThreadMonitorNode::ThreadMonitorNode(const rclcpp::NodeOptions & options)
+: Node("thread_monitor", options)
+{
+  RCLCPP_INFO(this->get_logger(), "Starting ThreadMonitorNode!");
+
+  processes_ = this->declare_parameter(
+    "processes", std::vector<std::string>{
+                   "camera_detector_container", "armor_detector_node", "armor_tracker_node",
+                   "rm_serial_driver_node"});
+  busy_warn_ratio_ = this->declare_parameter("busy_warn_ratio", 0.9);
+  perf_counters_ = this->declare_parameter("perf_counters", false);
+  double rate = this->declare_parameter("publish_rate", 1.0);
+
+  threads_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "~/threads", rclcpp::SystemDefaultsQoS());
+
+  report_srv_ = this->create_service<std_srvs::srv::Trigger>(
+    "~/report", std::bind(
+                  &ThreadMonitorNode::reportCallback, this, std::placeholders::_1,
+                  std::placeholders::_2));
+
+  last_sample_time_ = this->now();
+  timer_ = this->create_wall_timer(
+    std::chrono::duration<double>(1.0 / rate), std::bind(&ThreadMonitorNode::sample, this));
+}
+
+void ThreadMonitorNode::sample()
+{
+  auto now = this->now();
+  double dt = (now - last_sample_time_).seconds();
+  last_sample_time_ = now;
+
+  std::map<int, ThreadSample> samples;
+  std::vector<ThreadUsage> usages;
+  for (int pid : findProcesses(processes_)) {
+    auto process = processLabel(pid);
+    for (int tid : listThreads(pid)) {
+      ThreadSample sample;
+      if (!readThreadSample(pid, tid, sample)) {
+        continue;
+      }
+      sample.process = process;
+
+      ThreadUsage usage;
+      usage.sample = sample;
+      auto last = last_samples_.find(tid);
+      if (last != last_samples_.end() && dt > 0.0) {
+        const auto & prev = last->second;
+        double run_ns = static_cast<double>(sample.cpu_time_ns - prev.cpu_time_ns);
+        double delay_ns = static_cast<double>(sample.run_delay_ns - prev.run_delay_ns);
+        uint64_t slices = sample.timeslices - prev.timeslices;
+        uint64_t switches = sample.voluntary_ctxt_switches + sample.nonvoluntary_ctxt_switches -
+                            prev.voluntary_ctxt_switches - prev.nonvoluntary_ctxt_switches;
+        usage.busy_ratio = run_ns / (dt * 1e9);
+        usage.wait_ratio = delay_ns / (dt * 1e9);
+        usage.wait_per_slice_us = slices > 0 ? delay_ns / slices / 1e3 : 0.0;
+        usage.ctxt_switches_per_sec = switches / dt;
+      }
+      if (perf_counters_) {
+        sampleCounters(tid, dt, usage);
+      }
+
+      samples[tid] = sample;
+      usages.push_back(usage);
+    }
+  }
+  last_samples_ = std::move(samples);
+
+  // Release the counters of threads that have exited
+  for (auto it = counters_.begin(); it != counters_.end();) {
+    it = last_samples_.count(it->first) ? std::next(it) : counters_.erase(it);
+  }
+
+  diagnostic_msgs::msg::DiagnosticArray array;
+  array.header.stamp = now;
+  for (const auto & usage : usages) {
+    array.status.push_back(toStatus(usage));
+  }
+  threads_pub_->publish(array);
+
+  std::lock_guard<std::mutex> lock(usages_mutex_);
+  usages_ = std::move(usages);
+}
+
+void ThreadMonitorNode::sampleCounters(int tid, double dt, ThreadUsage & usage)
+{
+  auto & counters = counters_[tid];
+  if (!counters.group) {
+    counters.group = std::make_unique<PerfCounterGroup>();
+    if (!counters.group->open(tid)) {
+      // The thread may just have exited, anything else means counters are not available here
+      if (errno != ESRCH) {
+        RCLCPP_WARN(
+          this->get_logger(), "Hardware counters unavailable (%s), disabling them",
+          std::strerror(errno));
+        perf_counters_ = false;
+        counters_.clear();
+      }
+      return;
+    }
+  }
+
+  PerfCounterGroup::Values values;
+  if (!counters.group->read(values)) {
+    return;
+  }
+  if (counters.has_last && dt > 0.0) {
+    const auto & prev = counters.last;
+    double cycles = static_cast<double>(values.cycles - prev.cycles);
+    usage.has_counters = true;
+    usage.cycles_per_sec = cycles / dt;
+    usage.instructions_per_cycle =
+      cycles > 0.0 ? (values.instructions - prev.instructions) / cycles : 0.0;
+    usage.cache_misses_per_sec = (values.cache_misses - prev.cache_misses) / dt;
+    usage.branch_misses_per_sec = (values.branch_misses - prev.branch_misses) / dt;
+  }
+  counters.last = values;
+  counters.has_last = true;
+}
+
+diagnostic_msgs::msg::DiagnosticStatus ThreadMonitorNode::toStatus(const ThreadUsage & usage) const
+{
+  const auto & s = usage.sample;
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = s.process + "/" + s.name + " (" + std::to_string(s.tid) + ")";
+  status.hardware_id = std::to_string(s.pid);
+  if (usage.busy_ratio > busy_warn_ratio_) {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::WARN;
+    status.message = "Saturated";
+  } else {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.message = "OK";
+  }
+
+  auto add = [&status](const std::string & key, const std::string & value) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = key;
+    kv.value = value;
+    status.values.push_back(kv);
+  };
+  add("tid", std::to_string(s.tid));
+  add("processor", std::to_string(s.processor));
+  add("cpus_allowed", s.cpus_allowed);
+  add("policy", policyName(s.policy));
+  add("rt_priority", std::to_string(s.rt_priority));
+  add("nice", std::to_string(s.nice));
+  add("busy_ratio", std::to_string(usage.busy_ratio));
+  add("wait_ratio", std::to_string(usage.wait_ratio));
+  add("wait_per_slice_us", std::to_string(usage.wait_per_slice_us));
+  add("ctxt_switches_per_sec", std::to_string(usage.ctxt_switches_per_sec));
+  if (usage.has_counters) {
+    add("cycles_per_sec", std::to_string(usage.cycles_per_sec));
+    add("instructions_per_cycle", std::to_string(usage.instructions_per_cycle));
+    add("cache_misses_per_sec", std::to_string(usage.cache_misses_per_sec));
+    add("branch_misses_per_sec", std::to_string(usage.branch_misses_per_sec));
+  }
+  return status;
+}
+
+void ThreadMonitorNode::reportCallback(
+  const std_srvs::srv::Trigger::Request::SharedPtr,
+  std_srvs::srv::Trigger::Response::SharedPtr response)
+{
+  std::lock_guard<std::mutex> lock(usages_mutex_);
+
+  std::string report;
+  char line[256];
+  std::snprintf(
+    line, sizeof(line), "%-28s %-16s %7s %4s %-8s %-6s %4s %6s %6s %9s %9s %6s %9s %9s\n",
+    "process", "thread", "tid", "cpu", "allowed", "policy", "prio", "busy%", "wait%", "wait/us",
+    "csw/s", "ipc", "llcmiss/s", "brmiss/s");
+  report += line;
+  for (const auto & usage : usages_) {
+    const auto & s = usage.sample;
+    std::snprintf(
+      line, sizeof(line), "%-28s %-16s %7d %4d %-8s %-6s %4d %6.1f %6.1f %9.1f %9.1f",
+      s.process.c_str(), s.name.c_str(), s.tid, s.processor, s.cpus_allowed.c_str(),
+      policyName(s.policy).c_str(), s.rt_priority, usage.busy_ratio * 100.0,
+      usage.wait_ratio * 100.0, usage.wait_per_slice_us, usage.ctxt_switches_per_sec);
+    report += line;
+    if (usage.has_counters) {
+      std::snprintf(
+        line, sizeof(line), " %6.2f %9.0f %9.0f\n", usage.instructions_per_cycle,
+        usage.cache_misses_per_sec, usage.branch_misses_per_sec);
+    } else {
+      std::snprintf(line, sizeof(line), " %6s %9s %9s\n", "-", "-", "-");
+    }
+    report += line;
+  }
+
+  response->success = !usages_.empty();
+  response->message = usages_.empty() ? "No monitored threads found" : report;
+}
+
+}  // namespace rm_vision_bringup
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(rm_vision_bringup::ThreadMonitorNode)
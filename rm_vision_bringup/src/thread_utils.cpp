@@ -0,0 +1,25 @@
+// Copyright 2023 Chen Jun
+
+#include "rm_vision_bringup/thread_utils.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace rm_vision_bringup
+{
+bool pinCurrentThread(int cpu)
+{
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+}
+
+bool setCurrentThreadFifo(int priority)
+{
+  sched_param param{};
+  param.sched_priority = priority;
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+}  // namespace rm_vision_bringup
@@ -0,0 +1,238 @@
+// Copyright 2023 Chen Jun
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/capture_ring.hpp"
+
+using rm_vision_bringup::CaptureRing;
+
+namespace
+{
+// Payload of record `seq`: the sequence number, then `seq` repeated in every byte.
+// Sequence numbers stay below 0x5AA5 so a payload never looks like a record header.
+std::vector<uint8_t> makePayload(uint64_t seq, size_t length)
+{
+  std::vector<uint8_t> payload(std::max<size_t>(length, sizeof(seq)), static_cast<uint8_t>(seq));
+  std::memcpy(payload.data(), &seq, sizeof(seq));
+  return payload;
+}
+
+void append(CaptureRing & ring, uint64_t seq)
+{
+  auto payload = makePayload(seq, 8 + seq % 40);
+  ring.append(0, static_cast<int64_t>(seq), payload.data(), payload.size());
+}
+
+struct Parsed
+{
+  std::vector<uint64_t> seqs;
+  bool corrupted = false;
+};
+
+// Walks the records like serial_capture_decode.py, resyncing on the first header and checking
+// every payload after that
+Parsed parse(const std::vector<uint8_t> & bytes, uint64_t start)
+{
+  Parsed parsed;
+  bool synced = start == 0;
+  size_t pos = 0;
+  while (pos + sizeof(CaptureRing::RecordHeader) <= bytes.size()) {
+    CaptureRing::RecordHeader header;
+    std::memcpy(&header, bytes.data() + pos, sizeof(header));
+    size_t end = pos + sizeof(header) + header.length;
+    if (header.sync != CaptureRing::kSync || end > bytes.size()) {
+      if (synced) {
+        parsed.corrupted = true;
+        return parsed;
+      }
+      pos += 8;
+      continue;
+    }
+    synced = true;
+
+    uint64_t seq;
+    std::memcpy(&seq, bytes.data() + pos + sizeof(header), sizeof(seq));
+    auto expected = makePayload(seq, header.length);
+    if (
+      header.stamp_ns != static_cast<int64_t>(seq) || expected.size() != header.length ||
+      std::memcmp(expected.data(), bytes.data() + pos + sizeof(header), header.length) != 0)
+    {
+      parsed.corrupted = true;
+      return parsed;
+    }
+    parsed.seqs.push_back(seq);
+    pos = (end + 7) & ~size_t{7};
+  }
+  return parsed;
+}
+
+std::string tempPath(const char * name)
+{
+  std::string path = ::testing::TempDir() + name;
+  std::remove(path.c_str());
+  return path;
+}
+
+// Consecutive sequence numbers ending at last
+void expectTail(const Parsed & parsed, uint64_t last)
+{
+  ASSERT_FALSE(parsed.corrupted);
+  ASSERT_FALSE(parsed.seqs.empty());
+  EXPECT_EQ(parsed.seqs.back(), last);
+  for (size_t i = 1; i < parsed.seqs.size(); i++) {
+    EXPECT_EQ(parsed.seqs[i], parsed.seqs[i - 1] + 1);
+  }
+}
+}  // namespace
+
+TEST(CaptureRingTest, WrapKeepsNewestRecords)
+{
+  auto path = tempPath("capture_ring_wrap.ring");
+  CaptureRing ring;
+  ASSERT_TRUE(ring.open(path, 1024));
+  for (uint64_t seq = 1; seq <= 500; seq++) {
+    append(ring, seq);
+  }
+
+  uint64_t start = 0;
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(CaptureRing::readTail(path, 1 << 20, start, bytes));
+  EXPECT_LE(bytes.size(), 1024u);
+  Parsed parsed = parse(bytes, start);
+  expectTail(parsed, 500);
+  // Records are at most 64 bytes, so a 1 KiB ring holds more than a dozen of them
+  EXPECT_GT(parsed.seqs.size(), 12u);
+
+  // A smaller tail is a suffix of the full one
+  ASSERT_TRUE(CaptureRing::readTail(path, 200, start, bytes));
+  EXPECT_LE(bytes.size(), 200u);
+  expectTail(parse(bytes, start), 500);
+}
+
+TEST(CaptureRingTest, ReopenKeepsRecordsOfSameCapacity)
+{
+  auto path = tempPath("capture_ring_reopen.ring");
+  {
+    CaptureRing ring;
+    ASSERT_TRUE(ring.open(path, 4096));
+    for (uint64_t seq = 1; seq <= 10; seq++) {
+      append(ring, seq);
+    }
+  }
+  {
+    CaptureRing ring;
+    ASSERT_TRUE(ring.open(path, 4096));
+    for (uint64_t seq = 11; seq <= 20; seq++) {
+      append(ring, seq);
+    }
+  }
+
+  uint64_t start = 0;
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(CaptureRing::readTail(path, 1 << 20, start, bytes));
+  Parsed parsed = parse(bytes, start);
+  expectTail(parsed, 20);
+  EXPECT_EQ(parsed.seqs.front(), 1u);
+
+  // Another capacity starts a new ring
+  {
+    CaptureRing ring;
+    ASSERT_TRUE(ring.open(path, 2048));
+    append(ring, 1);
+  }
+  ASSERT_TRUE(CaptureRing::readTail(path, 1 << 20, start, bytes));
+  parsed = parse(bytes, start);
+  expectTail(parsed, 1);
+  EXPECT_EQ(parsed.seqs.size(), 1u);
+}
+
+TEST(CaptureRingTest, TailSkipsRecordTornByCrash)
+{
+  auto path = tempPath("capture_ring_torn.ring");
+  const size_t capacity = 1024;
+  {
+    CaptureRing ring;
+    ASSERT_TRUE(ring.open(path, capacity));
+    for (uint64_t seq = 1; seq <= 200; seq++) {
+      append(ring, seq);
+    }
+  }
+
+  // Simulate a writer that claimed a 128-byte record and died after writing half of it
+  // over the oldest records
+  int fd = ::open(path.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  size_t size = sizeof(CaptureRing::RingHeader) + capacity;
+  void * addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(addr, MAP_FAILED);
+  auto * header = static_cast<CaptureRing::RingHeader *>(addr);
+  auto * data = static_cast<uint8_t *>(addr) + sizeof(CaptureRing::RingHeader);
+  uint64_t pos = header->write_pos.load();
+  header->claim_pos.store(pos + 128);
+  for (uint64_t i = 0; i < 64; i++) {
+    data[(pos + i) % capacity] = 0xEE;
+  }
+  munmap(addr, size);
+
+  uint64_t start = 0;
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(CaptureRing::readTail(path, 1 << 20, start, bytes));
+  EXPECT_GE(start, pos + 128 - capacity);
+  expectTail(parse(bytes, start), 200);
+
+  // Reopening continues after the last complete record and keeps excluding the torn range
+  {
+    CaptureRing ring;
+    ASSERT_TRUE(ring.open(path, capacity));
+    append(ring, 201);
+  }
+  ASSERT_TRUE(CaptureRing::readTail(path, 1 << 20, start, bytes));
+  EXPECT_GE(start, pos + 128 - capacity);
+  expectTail(parse(bytes, start), 201);
+}
+
+TEST(CaptureRingTest, TailWhileWriterAdvances)
+{
+  auto path = tempPath("capture_ring_concurrent.ring");
+  CaptureRing ring;
+  ASSERT_TRUE(ring.open(path, 2048));
+
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    for (uint64_t seq = 1; seq < 20000; seq++) {
+      append(ring, seq);
+    }
+    done = true;
+  });
+
+  // Failures break out instead of returning, the writer thread must be joined
+  int reads = 0;
+  bool ok = true;
+  while (ok && (!done || reads < 10)) {
+    uint64_t start = 0;
+    std::vector<uint8_t> bytes;
+    ok = CaptureRing::readTail(path, 1 << 20, start, bytes);
+    Parsed parsed = parse(bytes, start);
+    ok = ok && !parsed.corrupted;
+    for (size_t i = 1; ok && i < parsed.seqs.size(); i++) {
+      ok = parsed.seqs[i] == parsed.seqs[i - 1] + 1;
+    }
+    EXPECT_TRUE(ok) << "read " << reads << " from " << start;
+    reads++;
+  }
+  writer.join();
+}
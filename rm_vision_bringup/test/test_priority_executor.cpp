@@ -0,0 +1,160 @@
+// Copyright 2023 Chen Jun
+
+#include <gtest/gtest.h>
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <std_msgs/msg/empty.hpp>
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rm_vision_bringup/priority_executor.hpp"
+
+using namespace std::chrono_literals;
+using rm_vision_bringup::PriorityExecutor;
+
+namespace
+{
+class PriorityExecutorTest : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase() { rclcpp::init(0, nullptr); }
+
+  static void TearDownTestCase() { rclcpp::shutdown(); }
+
+  // Spins until `done` or a timeout, cancelling from this thread so a failure cannot hang
+  static void spinUntil(PriorityExecutor & executor, const std::function<bool()> & done)
+  {
+    std::thread spinner([&executor]() { executor.spin(); });
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    executor.cancel();
+    spinner.join();
+  }
+
+  static void waitForSubscriber(const rclcpp::Publisher<std_msgs::msg::Empty>::SharedPtr & pub)
+  {
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (pub->get_subscription_count() == 0 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+};
+}  // namespace
+
+TEST_F(PriorityExecutorTest, HighPrioritySubscriptionRunsBeforeReadyTimer)
+{
+  auto high = std::make_shared<rclcpp::Node>("high");
+  auto low = std::make_shared<rclcpp::Node>("low");
+  auto publisher = std::make_shared<rclcpp::Node>("publisher");
+
+  // Read by the test thread only after the executor stopped
+  std::vector<std::string> order;
+  std::atomic<int> callbacks{0};
+  auto sub = high->create_subscription<std_msgs::msg::Empty>(
+    "priority_test", 10, [&](std_msgs::msg::Empty::ConstSharedPtr) {
+      order.push_back("high");
+      callbacks++;
+    });
+  rclcpp::TimerBase::SharedPtr timer;
+  timer = low->create_wall_timer(1ms, [&]() {
+    timer->cancel();
+    order.push_back("low");
+    callbacks++;
+  });
+
+  // The timer is long due and the message delivered when the executor first looks for work
+  auto pub = publisher->create_publisher<std_msgs::msg::Empty>("priority_test", 10);
+  waitForSubscriber(pub);
+  pub->publish(std_msgs::msg::Empty());
+  std::this_thread::sleep_for(200ms);
+
+  PriorityExecutor executor;
+  executor.setNodePriority("high", 90, 0ms);
+  executor.setNodePriority("low", 10, 0ms);
+  executor.add_node(low);
+  executor.add_node(high);
+  spinUntil(executor, [&callbacks]() { return callbacks >= 2; });
+
+  ASSERT_EQ(order.size(), 2u);
+  EXPECT_EQ(order[0], "high");
+  EXPECT_EQ(order[1], "low");
+}
+
+TEST_F(PriorityExecutorTest, MessagePublishedByCallbackIsNotChargedItsRunTime)
+{
+  auto detector = std::make_shared<rclcpp::Node>("detector");
+  auto tracker = std::make_shared<rclcpp::Node>("tracker");
+
+  // The detector runs 20 ms and publishes at its end, like armors handed to the tracker
+  auto pub = detector->create_publisher<std_msgs::msg::Empty>("armors_test", 10);
+  rclcpp::TimerBase::SharedPtr timer;
+  timer = detector->create_wall_timer(1ms, [&]() {
+    timer->cancel();
+    std::this_thread::sleep_for(20ms);
+    pub->publish(std_msgs::msg::Empty());
+  });
+  std::atomic<int> received{0};
+  auto sub = tracker->create_subscription<std_msgs::msg::Empty>(
+    "armors_test", 10, [&received](std_msgs::msg::Empty::ConstSharedPtr) { received++; });
+  waitForSubscriber(pub);
+
+  PriorityExecutor executor;
+  executor.setNodePriority("detector", 90, 0ms);
+  executor.setNodePriority("tracker", 80, 10ms);
+  executor.add_node(detector);
+  executor.add_node(tracker);
+  spinUntil(executor, [&received]() { return received > 0; });
+
+  ASSERT_EQ(received, 1);
+  std::string report = executor.report();
+  EXPECT_TRUE(std::regex_search(report, std::regex("tracker +priority +80 +1 callbacks +0 over")))
+    << report;
+}
+
+TEST_F(PriorityExecutorTest, LowerPriorityWorkRunsWhileHigherIsIdle)
+{
+  auto idle = std::make_shared<rclcpp::Node>("idle");
+  auto middle = std::make_shared<rclcpp::Node>("middle");
+  auto low = std::make_shared<rclcpp::Node>("low");
+  auto publisher = std::make_shared<rclcpp::Node>("publisher");
+
+  // Nothing is ever published to the highest priority
+  auto idle_sub = idle->create_subscription<std_msgs::msg::Empty>(
+    "idle_test", 10, [](std_msgs::msg::Empty::ConstSharedPtr) {});
+  std::atomic<int> middle_received{0};
+  auto middle_sub = middle->create_subscription<std_msgs::msg::Empty>(
+    "middle_test", 10,
+    [&middle_received](std_msgs::msg::Empty::ConstSharedPtr) { middle_received++; });
+  std::atomic<int> low_calls{0};
+  auto timer = low->create_wall_timer(10ms, [&low_calls]() { low_calls++; });
+
+  auto pub = publisher->create_publisher<std_msgs::msg::Empty>("middle_test", 10);
+  waitForSubscriber(pub);
+  for (int i = 0; i < 3; i++) {
+    pub->publish(std_msgs::msg::Empty());
+  }
+  std::this_thread::sleep_for(200ms);
+
+  PriorityExecutor executor;
+  executor.setNodePriority("idle", 90, 0ms);
+  executor.setNodePriority("middle", 80, 0ms);
+  executor.setNodePriority("low", 70, 0ms);
+  executor.add_node(idle);
+  executor.add_node(middle);
+  executor.add_node(low);
+  spinUntil(executor, [&]() { return middle_received >= 3 && low_calls >= 3; });
+
+  EXPECT_EQ(middle_received, 3);
+  EXPECT_GE(low_calls, 3);
+}